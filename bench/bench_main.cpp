@@ -0,0 +1,216 @@
+// Host-side benchmark for the import hot path: parse, emit and compress,
+// timed separately over synthetic levels of increasing size.
+//
+//   ig2gd_bench [--iterations N] [--sizes 1000,10000,...] [--write-dir DIR]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+#include "block_decoder.hpp"
+#include "compressor.hpp"
+#include "emitter.hpp"
+#include "import_arena.hpp"
+#include "level.hpp"
+#include "level_generator.hpp"
+
+static std::atomic<size_t> g_allocations = 0;
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+// MSVC has no std::aligned_alloc, and what _aligned_malloc returns has to be
+// freed with _aligned_free rather than free
+static void* alignedAlloc(size_t size, size_t align) {
+    #ifdef _MSC_VER
+    return _aligned_malloc(size, align);
+    #else
+    return std::aligned_alloc(align, (size + align - 1) / align * align);
+    #endif
+}
+
+static void alignedFree(void* ptr) {
+    #ifdef _MSC_VER
+    _aligned_free(ptr);
+    #else
+    std::free(ptr);
+    #endif
+}
+
+// std::pmr::new_delete_resource allocates through the aligned forms
+void* operator new(size_t size, std::align_val_t alignment) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = alignedAlloc(std::max<size_t>(size, 1), static_cast<size_t>(alignment))) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    alignedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    alignedFree(ptr);
+}
+
+namespace {
+    struct PhaseResult {
+        double seconds = 0;
+        size_t allocations = 0;
+    };
+    
+    // Best of several runs, which is the least noisy figure for short phases
+    template <class F>
+    PhaseResult measure(int iterations, F&& phase) {
+        PhaseResult best { 1e300, 0 };
+        for (int i = 0; i < iterations; i++) {
+            size_t allocationsBefore = g_allocations.load();
+            auto start = std::chrono::steady_clock::now();
+            phase();
+            auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            size_t allocations = g_allocations.load() - allocationsBefore;
+            if (elapsed < best.seconds) best = { elapsed, allocations };
+        }
+        return best;
+    }
+    
+    void report(size_t objects, std::string_view phase, size_t bytes, PhaseResult const& result) {
+        std::printf(
+            "%9zu  %-18.*s %10.3f ms %10.1f MB/s %12.0f obj/s %10zu allocs\n",
+            objects, static_cast<int>(phase.size()), phase.data(),
+            result.seconds * 1000.0,
+            bytes / result.seconds / (1024.0 * 1024.0),
+            objects / result.seconds,
+            result.allocations
+        );
+    }
+    
+    void spawnThread(std::function<void()> job) {
+        std::thread(std::move(job)).detach();
+    }
+    
+    std::vector<size_t> parseSizes(std::string_view list) {
+        std::vector<size_t> sizes;
+        while (!list.empty()) {
+            auto comma = list.find(',');
+            sizes.push_back(std::strtoull(std::string(list.substr(0, comma)).c_str(), nullptr, 10));
+            list.remove_prefix(comma == std::string_view::npos ? list.size() : comma + 1);
+        }
+        return sizes;
+    }
+}
+
+int main(int argc, char** argv) {
+    int iterations = 5;
+    std::vector<size_t> sizes = { 1000, 10000, 100000, 1000000 };
+    std::filesystem::path writeDir;
+    
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) iterations = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--sizes" && i + 1 < argc) sizes = parseSizes(argv[++i]);
+        else if (arg == "--write-dir" && i + 1 < argc) writeDir = argv[++i];
+        else {
+            std::fprintf(stderr, "usage: %s [--iterations N] [--sizes 1000,10000,...] [--write-dir DIR]\n", argv[0]);
+            return 1;
+        }
+    }
+    
+    std::printf("block decoder: %.*s\n", static_cast<int>(blockDecoderName().size()), blockDecoderName().data());
+    std::printf("%9s  %-18s %13s %15s %16s %17s\n", "objects", "phase", "time", "throughput", "rate", "allocations");
+    
+    for (size_t target : sizes) {
+        GeneratorConfig config;
+        config.targetObjects = target;
+        config.seed = static_cast<uint32_t>(target);
+        auto data = generateLevel(config);
+        
+        if (!writeDir.empty()) {
+            std::filesystem::create_directories(writeDir);
+            auto path = writeDir / ("synthetic_" + std::to_string(target) + ".lvl");
+            if (!writeLevel(path, data)) {
+                std::fprintf(stderr, "failed to write %s\n", path.string().c_str());
+                return 1;
+            }
+        }
+        
+        Level level(std::span<const std::byte>(data.data(), data.size()));
+        if (!level.getLoadedSuccessfully()) {
+            std::fprintf(stderr, "generated level with %zu objects failed to parse\n", target);
+            return 1;
+        }
+        
+        auto levelString = buildObjectString(level);
+        size_t objects = std::count(levelString.begin(), levelString.end(), ';');
+        
+        report(objects, "parse", data.size(), measure(iterations, [&] {
+            Level parsed(std::span<const std::byte>(data.data(), data.size()));
+        }));
+        report(objects, "parse (arena)", data.size(), measure(iterations, [&] {
+            ImportArena arena(data.size());
+            Level parsed(std::span<const std::byte>(data.data(), data.size()), &arena);
+        }));
+        report(objects, "emit", levelString.size(), measure(iterations, [&] {
+            auto emitted = buildObjectString(level);
+        }));
+        report(objects, "emit (threads)", levelString.size(), measure(iterations, [&] {
+            auto emitted = buildObjectString(level, {}, &spawnThread);
+        }));
+        report(objects, "emit (sorted)", levelString.size(), measure(iterations, [&] {
+            EmitOptions sorted;
+            sorted.sortByX = true;
+            auto emitted = buildObjectString(level, sorted);
+        }));
+        report(objects, "compress", levelString.size(), measure(iterations, [&] {
+            ChunkedCompressor compressor;
+            compressor.write(levelString);
+            auto compressed = compressor.finish();
+        }));
+        report(objects, "compress (threads)", levelString.size(), measure(iterations, [&] {
+            ChunkedCompressor compressor(&spawnThread);
+            compressor.write(levelString);
+            auto compressed = compressor.finish();
+        }));
+        report(objects, "emit+compress", levelString.size(), measure(iterations, [&] {
+            auto compressed = buildCompressedObjectString(level, {}, &spawnThread);
+        }));
+        
+        // The whole import as the mod runs it, with the parse and emit
+        // scratch coming from one arena
+        ImportArena::Stats arenaStats;
+        report(objects, "import (arena)", levelString.size(), measure(iterations, [&] {
+            ImportArena arena(data.size());
+            Level parsed(std::span<const std::byte>(data.data(), data.size()), &arena);
+            auto compressed = buildCompressedObjectString(parsed, {}, &spawnThread);
+            arenaStats = arena.stats();
+        }));
+        std::printf(
+            "%9s  arena served %zu allocations (%zu KiB) from %zu heap buffers (%zu KiB)\n", "",
+            arenaStats.allocations, arenaStats.bytes / 1024, arenaStats.heapAllocations, arenaStats.heapBytes / 1024
+        );
+    }
+    
+    return 0;
+}
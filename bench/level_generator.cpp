@@ -0,0 +1,118 @@
+#include "level_generator.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <random>
+
+namespace {
+    constexpr int GRID_SIZE = 30;
+    constexpr int COLOR_COUNT = 6;
+    
+    class LevelBuilder {
+        private:
+        std::vector<std::byte> m_data;
+        
+        public:
+        void u8(uint8_t value) { m_data.push_back(static_cast<std::byte>(value)); }
+        void u16(uint16_t value) {
+            u8(static_cast<uint8_t>(value >> 8));
+            u8(static_cast<uint8_t>(value));
+        }
+        void i32(int32_t value) {
+            auto bits = static_cast<uint32_t>(value);
+            for (int shift = 24; shift >= 0; shift -= 8) u8(static_cast<uint8_t>(bits >> shift));
+        }
+        void reserve(size_t size) { m_data.reserve(size); }
+        std::vector<std::byte> take() { return std::move(m_data); }
+    };
+}
+
+std::vector<std::byte> generateLevel(GeneratorConfig const& config) {
+    std::mt19937 rng(config.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::uniform_int_distribution<int> height(0, 4);
+    std::uniform_int_distribution<int> gap(0, 3);
+    
+    // Pits have to absorb whatever the record cap can't, so work out how wide
+    // they need to be on average
+    size_t records = std::min(config.targetObjects, MAX_BLOCK_RECORDS);
+    size_t pitRecords = std::max<size_t>(1, static_cast<size_t>(records * config.pitShare));
+    size_t otherObjects = records - pitRecords;
+    size_t pitObjects = config.targetObjects > otherObjects ? config.targetObjects - otherObjects : pitRecords;
+    int averagePitWidth = static_cast<int>(std::max<size_t>(1, pitObjects / pitRecords));
+    std::uniform_int_distribution<int> pitWidth(std::max(1, averagePitWidth / 2), averagePitWidth + averagePitWidth / 2);
+    
+    LevelBuilder builder;
+    builder.reserve(16 + records * 9 + config.targetObjects / 8);
+    
+    builder.i32(1); // format version
+    builder.u8(0);  // custom graphics
+    builder.u16(static_cast<uint16_t>(records));
+    
+    int x = 0;
+    for (size_t i = 0; i < records; i++) {
+        double roll = unit(rng);
+        x += gap(rng) * GRID_SIZE;
+        
+        if (roll < config.pitShare) {
+            int width = pitWidth(rng);
+            builder.u8(2);
+            builder.i32(x);
+            builder.i32(x + (width - 1) * GRID_SIZE);
+            x += width * GRID_SIZE;
+        } else {
+            builder.u8(roll < config.pitShare + config.spikeShare ? 1 : 0);
+            builder.i32(x);
+            builder.i32(height(rng) * GRID_SIZE);
+        }
+    }
+    
+    int endPos = x + 20 * GRID_SIZE;
+    builder.i32(endPos);
+    
+    auto spacedPositions = [&](int spacing) {
+        std::vector<int> positions;
+        for (int pos = spacing; pos < endPos; pos += spacing) {
+            positions.push_back(pos + static_cast<int>(unit(rng) * spacing / 2));
+        }
+        return positions;
+    };
+    
+    auto backgrounds = spacedPositions(config.backgroundSpacing);
+    builder.i32(static_cast<int32_t>(backgrounds.size()));
+    std::uniform_int_distribution<int> color(0, COLOR_COUNT - 1);
+    for (int pos : backgrounds) {
+        builder.i32(pos);
+        builder.u8(0);
+        builder.i32(color(rng));
+    }
+    
+    auto gravity = spacedPositions(config.gravitySpacing);
+    builder.i32(static_cast<int32_t>(gravity.size()));
+    for (int pos : gravity) builder.i32(pos);
+    
+    // Rises and falls alternate; each lasts a few hundred units, and every so
+    // often runs to the end of the level (start == end)
+    auto ranges = spacedPositions(config.riseFallSpacing);
+    std::vector<std::pair<int, int>> rises, falls;
+    for (size_t i = 0; i < ranges.size(); i++) {
+        int start = ranges[i];
+        int end = unit(rng) < 0.1 ? start : start + 300 + static_cast<int>(unit(rng) * 600);
+        (i % 2 == 0 ? rises : falls).emplace_back(start, end);
+    }
+    for (auto const* list : { &rises, &falls }) {
+        builder.i32(static_cast<int32_t>(list->size()));
+        for (auto [start, end] : *list) {
+            builder.i32(start);
+            builder.i32(end);
+        }
+    }
+    
+    return builder.take();
+}
+
+bool writeLevel(std::filesystem::path const& path, std::vector<std::byte> const& data) {
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    stream.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(stream);
+}
@@ -0,0 +1,30 @@
+#ifndef IG_LEVELGENERATOR
+#define IG_LEVELGENERATOR
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+// Settings for a synthetic TIG level. Object counts are counted the way the
+// emitter sees them, so a pit spanning five tiles counts as five objects.
+struct GeneratorConfig {
+    size_t targetObjects = 1000;
+    uint32_t seed = 1;
+    // Mix of block record types, as fractions of all block records
+    double spikeShare = 0.25;
+    double pitShare = 0.15;
+    // One of each event roughly every this many units of level length
+    int backgroundSpacing = 2400;
+    int gravitySpacing = 3600;
+    int riseFallSpacing = 9000;
+};
+
+// The .lvl block count is a u16, so at most this many block records fit in a
+// file. Larger targets are reached by widening pits instead.
+constexpr size_t MAX_BLOCK_RECORDS = 0xffff;
+
+std::vector<std::byte> generateLevel(GeneratorConfig const& config);
+bool writeLevel(std::filesystem::path const& path, std::vector<std::byte> const& data);
+
+#endif
@@ -0,0 +1,208 @@
+// Headless bulk converter: turns every TIG level under a folder into a .gmd
+// file, using the same parser and emitter as the mod. Levels are converted in
+// parallel on a work-stealing pool, one level per job. With --list, it only
+// prints a summary of each level found, without converting anything.
+//
+//   ig2gd_convert <input> <output dir> [--threads N] [--compact-geometry]
+//                 [--coalesce-triggers] [--sort-by-x] [--quiet]
+//   ig2gd_convert <input> --list
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "background_textures.hpp"
+#include "compressor.hpp"
+#include "gmd_writer.hpp"
+#include "import_arena.hpp"
+#include "level.hpp"
+#include "level_files.hpp"
+#include "level_summary.hpp"
+#include "mapped_file.hpp"
+#include "work_stealing_pool.hpp"
+
+namespace {
+    struct Conversion {
+        std::filesystem::path input;
+        std::filesystem::path output;
+        size_t inputBytes = 0;
+        size_t outputBytes = 0;
+        double seconds = 0;
+        std::optional<std::string> error;
+    };
+    
+    // Same checks and messages as the mod's import
+    std::optional<std::string> convertLevel(Conversion& conversion, EmitOptions const& options) {
+        MappedFile file(conversion.input);
+        if (!file.isOpen()) return "Failed to read the level file";
+        conversion.inputBytes = file.bytes().size();
+        
+        ImportArena arena(file.bytes().size());
+        Level level(file.bytes(), &arena);
+        if (level.getBlockCount() == 0 && level.getBackgroundCount() == 0 && level.getEndPos() == 3015) {
+            return "This is most likely not a valid Impossible Game level file";
+        }
+        if (!level.getLoadedSuccessfully()) {
+            return "This is not a valid Impossible Game level!";
+        }
+        
+        std::error_code ec;
+        std::filesystem::create_directories(conversion.output.parent_path(), ec);
+        
+        // Custom backgrounds tint the level's colour triggers
+        loadBackgroundTints(level, conversion.input.parent_path());
+        
+        auto levelString = buildCompressedObjectString(level, options);
+        if (!levelString) return "Failed to compress the imported level";
+        
+        if (!writeGmd(conversion.output, levelNameFromPath(conversion.input), *levelString)) {
+            return "Failed to write " + pathToUtf8(conversion.output);
+        }
+        conversion.outputBytes = levelString->size();
+        return std::nullopt;
+    }
+    
+    // Mirrors the input tree: a bundle folder or bare file named Foo.lvl
+    // becomes Foo.gmd at the same relative spot under the output folder
+    std::filesystem::path outputPathFor(std::filesystem::path const& root, std::filesystem::path const& levelFile, std::filesystem::path const& outputDir) {
+        auto level = hasLvlExtension(levelFile.parent_path()) ? levelFile.parent_path() : levelFile;
+        
+        std::error_code ec;
+        bool rootIsFolder = std::filesystem::is_directory(root, ec) && !hasLvlExtension(root);
+        auto relative = rootIsFolder ? level.lexically_relative(root) : level.filename();
+        relative.replace_extension(".gmd");
+        return outputDir / relative;
+    }
+    
+    // Header scans are cheap enough to do one after another; the whole
+    // listing is usually bound by walking the folder
+    int listLevels(std::vector<std::filesystem::path> const& files) {
+        auto start = std::chrono::steady_clock::now();
+        size_t failed = 0;
+        for (auto const& file : files) {
+            auto summary = readLevelSummary(file);
+            if (!summary || !summary->complete || !summary->looksLikeLevel()) {
+                std::printf("%-40s  not a valid level\n", levelNameFromPath(file).c_str());
+                failed++;
+                continue;
+            }
+            std::printf(
+                "%-40s  %7d blocks  end %7d  %3d backgrounds (%d custom)  %3d gravity  %3d rise  %3d fall\n",
+                levelNameFromPath(file).c_str(), summary->blockCount, summary->endPos,
+                summary->backgroundCount, summary->customBackgroundCount,
+                summary->gravityCount, summary->risingCount, summary->fallingCount
+            );
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("\nlisted %zu levels in %.3f ms\n", files.size(), elapsed * 1000.0);
+        return failed > 0 ? 1 : 0;
+    }
+    
+    int usage(const char* program) {
+        std::fprintf(stderr,
+            "usage: %s <input> <output dir> [--threads N] [--compact-geometry] [--coalesce-triggers] [--sort-by-x] [--quiet]\n"
+            "       %s <input> --list\n",
+            program, program
+        );
+        return 1;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string_view> positional;
+    size_t threads = 0;
+    bool quiet = false;
+    bool list = false;
+    EmitOptions options;
+    
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) threads = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--compact-geometry") options.compactGeometry = true;
+        else if (arg == "--coalesce-triggers") options.coalesceTriggers = true;
+        else if (arg == "--sort-by-x") options.sortByX = true;
+        else if (arg == "--quiet") quiet = true;
+        else if (arg == "--list") list = true;
+        else if (arg.starts_with("--")) return usage(argv[0]);
+        else positional.push_back(arg);
+    }
+    if (positional.size() != (list ? 1 : 2)) return usage(argv[0]);
+    
+    std::filesystem::path root(positional[0]);
+    
+    std::error_code ec;
+    std::vector<std::filesystem::path> files;
+    if (std::filesystem::is_regular_file(root, ec)) files.push_back(root);
+    else files = findLevelFilesInTree(root);
+    
+    if (files.empty()) {
+        std::fprintf(stderr, "no .lvl levels found under %s\n", pathToUtf8(root).c_str());
+        return 1;
+    }
+    if (list) return listLevels(files);
+    
+    std::filesystem::path outputDir(positional[1]);
+    std::vector<Conversion> conversions(files.size());
+    for (size_t i = 0; i < files.size(); i++) {
+        conversions[i].input = files[i];
+        conversions[i].output = outputPathFor(root, files[i], outputDir);
+    }
+    
+    std::mutex printMutex;
+    auto start = std::chrono::steady_clock::now();
+    {
+        WorkStealingPool pool(threads);
+        threads = pool.threadCount();
+        
+        for (auto& conversion : conversions) {
+            pool.submit([&conversion, &options, &printMutex, quiet] {
+                auto levelStart = std::chrono::steady_clock::now();
+                conversion.error = convertLevel(conversion, options);
+                conversion.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - levelStart).count();
+                
+                if (quiet && !conversion.error) return;
+                std::lock_guard lock(printMutex);
+                if (conversion.error) {
+                    std::fprintf(stderr, "%10.3f ms  FAILED  %s: %s\n",
+                        conversion.seconds * 1000.0, pathToUtf8(conversion.input).c_str(), conversion.error->c_str());
+                }
+                else {
+                    std::printf("%10.3f ms  %10zu -> %10zu bytes  %s\n",
+                        conversion.seconds * 1000.0, conversion.inputBytes, conversion.outputBytes, pathToUtf8(conversion.output).c_str());
+                }
+            });
+        }
+        pool.wait();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    size_t failed = 0;
+    size_t inputBytes = 0;
+    size_t outputBytes = 0;
+    double levelSeconds = 0;
+    for (auto const& conversion : conversions) {
+        if (conversion.error) failed++;
+        inputBytes += conversion.inputBytes;
+        outputBytes += conversion.outputBytes;
+        levelSeconds += conversion.seconds;
+    }
+    
+    std::printf(
+        "\nconverted %zu of %zu levels in %.3f s on %zu threads\n"
+        "  %.1f levels/s, %.1f MB/s in, %.1f MB/s out, %.1fx speedup over per-level time\n",
+        conversions.size() - failed, conversions.size(), elapsed, threads,
+        conversions.size() / elapsed,
+        inputBytes / elapsed / (1024.0 * 1024.0),
+        outputBytes / elapsed / (1024.0 * 1024.0),
+        levelSeconds / elapsed
+    );
+    if (failed > 0) std::printf("  %zu failed\n", failed);
+    
+    return failed > 0 ? 1 : 0;
+}
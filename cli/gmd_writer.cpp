@@ -0,0 +1,44 @@
+#include "gmd_writer.hpp"
+
+#include <fstream>
+
+namespace {
+    void appendEscaped(std::string& out, std::string_view text) {
+        for (char c : text) {
+            switch (c) {
+                case '&': out += "&amp;"; break;
+                case '<': out += "&lt;"; break;
+                case '>': out += "&gt;"; break;
+                default: out += c; break;
+            }
+        }
+    }
+}
+
+std::string buildGmd(std::string_view levelName, std::string_view levelString) {
+    std::string gmd;
+    gmd.reserve(levelString.size() + levelName.size() + 160);
+    
+    // kCEK 4 marks a level object; k21 2 is GJLevelType::Editor
+    gmd += "<?xml version=\"1.0\"?><plist version=\"1.0\" gjver=\"2.0\"><dict>";
+    gmd += "<k>kCEK</k><i>4</i>";
+    gmd += "<k>k2</k><s>";
+    appendEscaped(gmd, levelName);
+    gmd += "</s>";
+    // The level string is URL-safe base64, so it never needs escaping
+    gmd += "<k>k4</k><s>";
+    gmd += levelString;
+    gmd += "</s>";
+    gmd += "<k>k21</k><i>2</i>";
+    gmd += "</dict></plist>";
+    return gmd;
+}
+
+bool writeGmd(std::filesystem::path const& path, std::string_view levelName, std::string_view levelString) {
+    auto gmd = buildGmd(levelName, levelString);
+    
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    out.write(gmd.data(), static_cast<std::streamsize>(gmd.size()));
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,14 @@
+#ifndef IG_GMDWRITER
+#define IG_GMDWRITER
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+// Wraps a compressed level string in the .gmd plist GD's level sharing tools
+// import: the level's name, its data, and the editor level type, the same
+// fields the mod sets on the GJGameLevel it creates
+std::string buildGmd(std::string_view levelName, std::string_view levelString);
+bool writeGmd(std::filesystem::path const& path, std::string_view levelName, std::string_view levelString);
+
+#endif
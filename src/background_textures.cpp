@@ -0,0 +1,135 @@
+#include "background_textures.hpp"
+#include "hash.hpp"
+#include "level_files.hpp"
+#include "mapped_file.hpp"
+#include "png_codec.hpp"
+
+#include <future>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+
+namespace {
+    std::optional<std::filesystem::path> resolveTexture(std::filesystem::path const& stored, std::filesystem::path const& levelDir) {
+        std::error_code ec;
+        auto candidates = {
+            stored.is_absolute() ? stored : levelDir / stored,
+            levelDir / stored.filename(),
+        };
+        for (auto const& candidate : candidates) {
+            if (std::filesystem::is_regular_file(candidate, ec)) return candidate;
+        }
+        return std::nullopt;
+    }
+    
+    uint64_t hashText(std::string_view text) {
+        return hashBytes(std::as_bytes(std::span(text.data(), text.size())));
+    }
+    
+    int averageColor(Image const& image) {
+        uint64_t red = 0, green = 0, blue = 0, weight = 0;
+        for (size_t i = 0; i < image.pixels.size(); i += 4) {
+            uint32_t alpha = image.pixels[i + 3];
+            red += image.pixels[i] * alpha;
+            green += image.pixels[i + 1] * alpha;
+            blue += image.pixels[i + 2] * alpha;
+            weight += alpha;
+        }
+        if (weight == 0) return 0;
+        return static_cast<int>((red / weight) << 16 | (green / weight) << 8 | (blue / weight));
+    }
+}
+
+uint64_t hashBackgroundTextureStamps(std::vector<std::string> const& storedPaths, std::filesystem::path const& levelDir) {
+    uint64_t combined = 0;
+    for (auto const& stored : storedPaths) {
+        // A missing texture still counts, so adding it later changes the hash
+        auto path = resolveTexture(pathFromUtf8(stored), levelDir);
+        if (!path) {
+            combined = hashMix(combined ^ hashText(stored));
+            continue;
+        }
+        
+        std::error_code ec;
+        auto size = std::filesystem::file_size(*path, ec);
+        auto lastWrite = std::filesystem::last_write_time(*path, ec);
+        combined = hashMix(combined ^ hashText(pathToUtf8(*path)));
+        combined = hashMix(combined ^ static_cast<uint64_t>(size));
+        combined = hashMix(combined ^ static_cast<uint64_t>(lastWrite.time_since_epoch().count()));
+    }
+    return combined;
+}
+
+BackgroundTextures readBackgroundTextures(Level const& level, std::filesystem::path const& levelDir) {
+    BackgroundTextures result;
+    auto backgrounds = level.getBackgrounds();
+    result.textureForBackground.assign(backgrounds.size(), -1);
+    
+    // Resolved path -> texture, so a file used by many changes is read once;
+    // then contents -> texture, so copies under different names are merged
+    std::unordered_map<std::string, int> byPath;
+    std::unordered_map<uint64_t, int> byHash;
+    
+    for (size_t i = 0; i < backgrounds.size(); i++) {
+        if (!backgrounds[i].customTexture) continue;
+        
+        auto path = resolveTexture(pathFromUtf8(backgrounds[i].filePath), levelDir);
+        if (!path) continue;
+        
+        auto key = pathToUtf8(*path);
+        if (auto known = byPath.find(key); known != byPath.end()) {
+            result.textureForBackground[i] = known->second;
+            continue;
+        }
+        
+        MappedFile file(*path);
+        if (!file.isOpen()) continue;
+        
+        uint64_t hash = hashBytes(file.bytes());
+        auto [existing, inserted] = byHash.try_emplace(hash, static_cast<int>(result.textures.size()));
+        if (inserted) {
+            result.textures.push_back({ *path, std::vector<std::byte>(file.bytes().begin(), file.bytes().end()), hash });
+        }
+        byPath[key] = existing->second;
+        result.textureForBackground[i] = existing->second;
+    }
+    
+    return result;
+}
+
+std::vector<int> averageTextureColors(BackgroundTextures const& textures, JobExecutor const& executor) {
+    std::vector<int> colors(textures.textures.size(), -1);
+    std::vector<std::promise<void>> done(colors.size());
+    
+    // Every job references these locals, so each one has to signal even
+    // if decoding throws (running out of memory on a huge image, say);
+    // that texture then counts as one that failed to decode
+    for (size_t i = 0; i < colors.size(); i++) {
+        auto average = [&colors, &textures, &done, i] {
+            try {
+                if (auto image = decodePng(textures.textures[i].data)) colors[i] = averageColor(*image);
+            } catch (...) {
+                colors[i] = -1;
+            }
+            done[i].set_value();
+        };
+        if (executor) executor(average);
+        else average();
+    }
+    for (auto& promise : done) promise.get_future().wait();
+    return colors;
+}
+
+void applyBackgroundTints(Level& level, BackgroundTextures const& textures, std::vector<int> const& colors) {
+    for (size_t i = 0; i < textures.textureForBackground.size(); i++) {
+        int texture = textures.textureForBackground[i];
+        if (texture < 0 || colors[texture] < 0) continue;
+        level.setBackgroundTint(i, colors[texture]);
+    }
+}
+
+void loadBackgroundTints(Level& level, std::filesystem::path const& levelDir, JobExecutor const& executor) {
+    auto textures = readBackgroundTextures(level, levelDir);
+    applyBackgroundTints(level, textures, averageTextureColors(textures, executor));
+}
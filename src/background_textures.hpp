@@ -0,0 +1,50 @@
+#ifndef IG_BACKGROUNDTEXTURES
+#define IG_BACKGROUNDTEXTURES
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "emitter.hpp"
+#include "level.hpp"
+
+// A level's custom background images, read from disk but not decoded yet.
+// Files with identical contents are only kept once, however many background
+// changes use them or whatever they're called.
+struct BackgroundTextures {
+    struct Texture {
+        std::filesystem::path path;
+        std::vector<std::byte> data;
+        uint64_t hash = 0;
+    };
+    
+    std::vector<Texture> textures;
+    // Per background change: index into textures, or -1 if it isn't custom
+    // or its image couldn't be found
+    std::vector<int> textureForBackground;
+};
+
+// Custom texture paths are resolved against the folder holding the level
+// file, falling back to just the file name in case the level was moved
+BackgroundTextures readBackgroundTextures(Level const& level, std::filesystem::path const& levelDir);
+
+// Hash of where each custom texture resolves to and that file's size and
+// modification time, so a cache can tell the textures haven't changed without
+// reading them. Takes the paths as stored in the level (see
+// readCustomTexturePaths); 0 if there are none.
+uint64_t hashBackgroundTextureStamps(std::vector<std::string> const& storedPaths, std::filesystem::path const& levelDir);
+
+// Each texture's average colour as 0xRRGGBB, weighted by alpha, or -1 if it
+// couldn't be decoded. Textures are decoded on the executor, one job each,
+// and their pixels are dropped as soon as they've been averaged.
+std::vector<int> averageTextureColors(BackgroundTextures const& textures, JobExecutor const& executor = nullptr);
+
+// Gives each custom background change its texture's average colour, so the
+// emitter can turn texture swaps into colour changes
+void applyBackgroundTints(Level& level, BackgroundTextures const& textures, std::vector<int> const& colors);
+
+// All three steps, for callers that don't need the textures themselves
+void loadBackgroundTints(Level& level, std::filesystem::path const& levelDir, JobExecutor const& executor = nullptr);
+
+#endif
@@ -0,0 +1,222 @@
+#include "block_decoder.hpp"
+#include "byte_cursor.hpp"
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define IG_BLOCKDECODER_X86
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define IG_BLOCKDECODER_NEON
+    #include <arm_neon.h>
+#endif
+
+// Lets one translation unit hold code for several instruction sets; which
+// one runs is decided at runtime
+#if defined(__GNUC__) || defined(__clang__)
+    #define IG_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define IG_TARGET(isa)
+#endif
+
+namespace {
+    // Each decoder handles as many records from the front as it can and
+    // returns how many that was; the scalar loop finishes the rest
+    using BatchDecoder = size_t (*)(const std::byte* records, size_t count, BlockTable& table);
+    
+    struct Decoder {
+        std::string_view name;
+        BatchDecoder decode;
+    };
+    
+    // Offsets are added unsigned so out-of-range coordinates wrap the same
+    // way the vector adds do
+    void decodeScalar(const std::byte* records, size_t begin, size_t end, BlockTable& table) {
+        for (size_t i = begin; i < end; i++) {
+            const std::byte* record = records + i * BLOCK_RECORD_SIZE;
+            table.types[i] = static_cast<uint8_t>(record[0]);
+            table.xs[i] = static_cast<int32_t>(readBE32(record + 1) + static_cast<uint32_t>(BlockTable::X_OFFSET));
+            table.ys[i] = static_cast<int32_t>(readBE32(record + 5) + static_cast<uint32_t>(BlockTable::Y_OFFSET));
+        }
+    }
+    
+    size_t decodeNone(const std::byte*, size_t, BlockTable&) {
+        return 0;
+    }
+    
+    // The vector loops load 16 bytes starting at each record, which runs 7
+    // bytes into the next one, so a batch of N records needs record N to
+    // exist too. Every batch pulls x and y out of each record byte-swapped,
+    // then transposes the records into a run of xs and a run of ys.
+    
+    #ifdef IG_BLOCKDECODER_X86
+    
+    // x and y of the record at the start of a 16-byte load, byte-swapped into
+    // the low two lanes
+    #define IG_RECORD_SWAP 4, 3, 2, 1, 8, 7, 6, 5, -1, -1, -1, -1, -1, -1, -1, -1
+    
+    // Lambdas don't inherit a target attribute, so the loads are functions
+    IG_TARGET("ssse3")
+    inline __m128i loadSsse3(const std::byte* records, size_t i, __m128i swap) {
+        return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(records + i * BLOCK_RECORD_SIZE)), swap);
+    }
+    
+    IG_TARGET("ssse3")
+    size_t decodeSsse3(const std::byte* records, size_t count, BlockTable& table) {
+        const __m128i swap = _mm_setr_epi8(IG_RECORD_SWAP);
+        const __m128i xOffset = _mm_set1_epi32(BlockTable::X_OFFSET);
+        const __m128i yOffset = _mm_set1_epi32(BlockTable::Y_OFFSET);
+        
+        size_t i = 0;
+        for (; i + 4 < count; i += 4) {
+            __m128i front = _mm_unpacklo_epi32(loadSsse3(records, i, swap), loadSsse3(records, i + 1, swap));     // x0 x1 y0 y1
+            __m128i back = _mm_unpacklo_epi32(loadSsse3(records, i + 2, swap), loadSsse3(records, i + 3, swap));  // x2 x3 y2 y3
+            __m128i xs = _mm_add_epi32(_mm_unpacklo_epi64(front, back), xOffset);
+            __m128i ys = _mm_add_epi32(_mm_unpackhi_epi64(front, back), yOffset);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(table.xs.data() + i), xs);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(table.ys.data() + i), ys);
+            for (size_t j = 0; j < 4; j++) {
+                table.types[i + j] = static_cast<uint8_t>(records[(i + j) * BLOCK_RECORD_SIZE]);
+            }
+        }
+        return i;
+    }
+    
+    // Same as the SSSE3 loop with records i..i+3 in the low lane and
+    // i+4..i+7 in the high one, so the in-lane transpose lands in order
+    IG_TARGET("avx2")
+    inline __m256i loadAvx2(const std::byte* records, size_t i, __m256i swap) {
+        __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(records + i * BLOCK_RECORD_SIZE));
+        __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(records + (i + 4) * BLOCK_RECORD_SIZE));
+        return _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1), swap);
+    }
+    
+    IG_TARGET("avx2")
+    size_t decodeAvx2(const std::byte* records, size_t count, BlockTable& table) {
+        const __m256i swap = _mm256_setr_epi8(IG_RECORD_SWAP, IG_RECORD_SWAP);
+        const __m256i xOffset = _mm256_set1_epi32(BlockTable::X_OFFSET);
+        const __m256i yOffset = _mm256_set1_epi32(BlockTable::Y_OFFSET);
+        
+        size_t i = 0;
+        for (; i + 8 < count; i += 8) {
+            __m256i front = _mm256_unpacklo_epi32(loadAvx2(records, i, swap), loadAvx2(records, i + 1, swap));
+            __m256i back = _mm256_unpacklo_epi32(loadAvx2(records, i + 2, swap), loadAvx2(records, i + 3, swap));
+            __m256i xs = _mm256_add_epi32(_mm256_unpacklo_epi64(front, back), xOffset);
+            __m256i ys = _mm256_add_epi32(_mm256_unpackhi_epi64(front, back), yOffset);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(table.xs.data() + i), xs);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(table.ys.data() + i), ys);
+            for (size_t j = 0; j < 8; j++) {
+                table.types[i + j] = static_cast<uint8_t>(records[(i + j) * BLOCK_RECORD_SIZE]);
+            }
+        }
+        return i;
+    }
+    
+    #undef IG_RECORD_SWAP
+    
+    void cpuid(int leaf, uint32_t regs[4]) {
+        #ifdef _MSC_VER
+        int out[4];
+        __cpuidex(out, leaf, 0);
+        for (int i = 0; i < 4; i++) regs[i] = static_cast<uint32_t>(out[i]);
+        #else
+        __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+        #endif
+    }
+    
+    IG_TARGET("xsave")
+    uint64_t enabledXsaveFeatures() {
+        #ifdef _MSC_VER
+        return _xgetbv(0);
+        #else
+        uint32_t low, high;
+        __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+        return (static_cast<uint64_t>(high) << 32) | low;
+        #endif
+    }
+    
+    Decoder pickDecoder() {
+        uint32_t regs[4];
+        cpuid(0, regs);
+        uint32_t maxLeaf = regs[0];
+        
+        cpuid(1, regs);
+        bool ssse3 = regs[2] & (1u << 9);
+        bool osxsave = regs[2] & (1u << 27);
+        bool avx = regs[2] & (1u << 28);
+        
+        // AVX2 also needs the OS to save the upper halves of the registers
+        bool avx2 = false;
+        if (maxLeaf >= 7 && osxsave && avx && (enabledXsaveFeatures() & 0x6) == 0x6) {
+            cpuid(7, regs);
+            avx2 = regs[1] & (1u << 5);
+        }
+        
+        if (avx2) return { "avx2", &decodeAvx2 };
+        if (ssse3) return { "ssse3", &decodeSsse3 };
+        return { "scalar", &decodeNone };
+    }
+    
+    #elif defined(IG_BLOCKDECODER_NEON)
+    
+    // Every AArch64 CPU has NEON, so there's nothing to pick at runtime
+    size_t decodeNeon(const std::byte* records, size_t count, BlockTable& table) {
+        static constexpr uint8_t SWAP[16] = { 4, 3, 2, 1, 8, 7, 6, 5, 255, 255, 255, 255, 255, 255, 255, 255 };
+        const uint8x16_t swap = vld1q_u8(SWAP);
+        const int32x4_t xOffset = vdupq_n_s32(BlockTable::X_OFFSET);
+        const int32x4_t yOffset = vdupq_n_s32(BlockTable::Y_OFFSET);
+        auto load = [&](size_t i) {
+            auto bytes = vld1q_u8(reinterpret_cast<const uint8_t*>(records + i * BLOCK_RECORD_SIZE));
+            return vreinterpretq_u32_u8(vqtbl1q_u8(bytes, swap));
+        };
+        
+        size_t i = 0;
+        for (; i + 4 < count; i += 4) {
+            auto front = vreinterpretq_u64_u32(vzip1q_u32(load(i), load(i + 1)));    // x0 x1 y0 y1
+            auto back = vreinterpretq_u64_u32(vzip1q_u32(load(i + 2), load(i + 3))); // x2 x3 y2 y3
+            auto xs = vaddq_s32(vreinterpretq_s32_u64(vzip1q_u64(front, back)), xOffset);
+            auto ys = vaddq_s32(vreinterpretq_s32_u64(vzip2q_u64(front, back)), yOffset);
+            vst1q_s32(table.xs.data() + i, xs);
+            vst1q_s32(table.ys.data() + i, ys);
+            for (size_t j = 0; j < 4; j++) {
+                table.types[i + j] = static_cast<uint8_t>(records[(i + j) * BLOCK_RECORD_SIZE]);
+            }
+        }
+        return i;
+    }
+    
+    Decoder pickDecoder() {
+        return { "neon", &decodeNeon };
+    }
+    
+    #else
+    
+    Decoder pickDecoder() {
+        return { "scalar", &decodeNone };
+    }
+    
+    #endif
+    
+    Decoder const& decoder() {
+        static const Decoder picked = pickDecoder();
+        return picked;
+    }
+}
+
+void decodeBlockRecords(std::span<const std::byte> records, BlockTable& table) {
+    size_t count = records.size() / BLOCK_RECORD_SIZE;
+    table.resize(count);
+    if (count == 0) return;
+    
+    size_t decoded = decoder().decode(records.data(), count, table);
+    decodeScalar(records.data(), decoded, count, table);
+}
+
+std::string_view blockDecoderName() {
+    return decoder().name;
+}
@@ -0,0 +1,55 @@
+#ifndef IG_BLOCKDECODER
+#define IG_BLOCKDECODER
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include "byte_cursor.hpp"
+#include "gdstructs.hpp"
+
+// Where each field sits in a packed block record. Coordinates are big-endian
+// i32s, like every other number in a TIG file.
+struct BlockLayout {
+    size_t recordSize;
+    size_t typeOffset;
+    size_t xOffset;
+    size_t yOffset;
+    
+    constexpr bool operator==(BlockLayout const&) const = default;
+};
+
+// u8 type, i32 x, i32 y
+constexpr BlockLayout TIG_BLOCK_LAYOUT { 9, 0, 1, 5 };
+constexpr size_t BLOCK_RECORD_SIZE = TIG_BLOCK_LAYOUT.recordSize;
+
+// Decodes a run of TIG_BLOCK_LAYOUT records into the table, replacing whatever
+// it held. Records are byte-swapped in batches with SSSE3, AVX2 or NEON when the
+// CPU has them, and one at a time otherwise; the offsets BlockTable documents
+// are applied in the same pass. Trailing bytes short of a full record are
+// ignored.
+void decodeBlockRecords(std::span<const std::byte> records, BlockTable& table);
+
+// Which implementation decodeBlockRecords uses on this CPU
+std::string_view blockDecoderName();
+
+// Decodes records of any layout, the TIG one through decodeBlockRecords and
+// others one record at a time with their offsets fixed at compile time
+template <BlockLayout Layout>
+void decodeBlockRecordsAs(std::span<const std::byte> records, BlockTable& table) {
+    if constexpr (Layout == TIG_BLOCK_LAYOUT) {
+        decodeBlockRecords(records, table);
+    }
+    else {
+        size_t count = records.size() / Layout.recordSize;
+        table.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            const std::byte* record = records.data() + i * Layout.recordSize;
+            table.types[i] = static_cast<uint8_t>(record[Layout.typeOffset]);
+            table.xs[i] = static_cast<int32_t>(readBE32(record + Layout.xOffset) + static_cast<uint32_t>(BlockTable::X_OFFSET));
+            table.ys[i] = static_cast<int32_t>(readBE32(record + Layout.yOffset) + static_cast<uint32_t>(BlockTable::Y_OFFSET));
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef IG_BYTECURSOR
+#define IG_BYTECURSOR
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+// Unchecked, for records whose bounds were already checked as a whole
+inline uint32_t readBE32(const std::byte* bytes) {
+    return (static_cast<uint32_t>(bytes[0]) << 24)
+        | (static_cast<uint32_t>(bytes[1]) << 16)
+        | (static_cast<uint32_t>(bytes[2]) << 8)
+        | static_cast<uint32_t>(bytes[3]);
+}
+
+// Big-endian reader over a borrowed byte range. Every read is bounds-checked;
+// the first read that would run past the end marks the cursor as failed and
+// every read after that returns 0, so callers only need to check ok() once
+// per record instead of once per field.
+class ByteCursor {
+    private:
+    std::span<const std::byte> m_data;
+    size_t m_offset = 0;
+    bool m_ok = true;
+    
+    bool take(size_t count) {
+        if (!m_ok || m_data.size() - m_offset < count) {
+            m_ok = false;
+            return false;
+        }
+        return true;
+    }
+    
+    uint32_t byteAt(size_t i) const { return static_cast<uint32_t>(m_data[m_offset + i]); }
+    
+    public:
+    explicit ByteCursor(std::span<const std::byte> data) : m_data(data) {}
+    
+    bool ok() const { return m_ok; }
+    explicit operator bool() const { return m_ok; }
+    size_t offset() const { return m_offset; }
+    size_t remaining() const { return m_ok ? m_data.size() - m_offset : 0; }
+    
+    uint8_t readU8() {
+        if (!take(1)) return 0;
+        return static_cast<uint8_t>(m_data[m_offset++]);
+    }
+    
+    uint16_t readU16() {
+        if (!take(2)) return 0;
+        uint16_t value = static_cast<uint16_t>((byteAt(0) << 8) | byteAt(1));
+        m_offset += 2;
+        return value;
+    }
+    
+    int32_t readI32() {
+        if (!take(4)) return 0;
+        uint32_t value = (byteAt(0) << 24) | (byteAt(1) << 16) | (byteAt(2) << 8) | byteAt(3);
+        m_offset += 4;
+        return static_cast<int32_t>(value);
+    }
+    
+    std::string_view readString(size_t length) {
+        if (!take(length)) return {};
+        std::string_view value(reinterpret_cast<const char*>(m_data.data() + m_offset), length);
+        m_offset += length;
+        return value;
+    }
+    
+    std::span<const std::byte> readBytes(size_t length) {
+        if (!take(length)) return {};
+        auto value = m_data.subspan(m_offset, length);
+        m_offset += length;
+        return value;
+    }
+    
+    void skip(size_t count) {
+        if (take(count)) m_offset += count;
+    }
+    
+    // Upper bound on how many records of the given size can still be read,
+    // used to clamp reservations against corrupt count fields
+    size_t maxRecords(size_t recordSize) const { return remaining() / recordSize; }
+};
+
+#endif
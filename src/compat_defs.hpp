@@ -18,6 +18,10 @@
 
 #define level_string_base "kS38,1_63_2_184_3_199_11_255_12_255_13_255_4_-1_6_1000_7_1_15_1_18_0_8_1|1_63_2_184_3_199_11_255_12_255_13_255_4_-1_6_1001_7_1_15_1_18_0_8_1|1_63_2_184_3_199_11_255_12_255_13_255_4_-1_6_1009_7_1_15_1_18_0_8_1|1_255_2_255_3_255_11_255_12_255_13_255_4_-1_6_1002_5_1_7_1_15_1_18_0_8_1|1_40_2_125_3_255_11_255_12_255_13_255_4_-1_6_1013_7_1_15_1_18_0_8_1|1_40_2_125_3_255_11_255_12_255_13_255_4_-1_6_1014_7_1_15_1_18_0_8_1|1_255_2_0_3_255_11_255_12_255_13_255_4_-1_6_1005_5_1_7_1_15_1_18_0_8_1|1_0_2_0_3_255_11_255_12_255_13_255_4_-1_6_1006_5_1_7_1_15_1_18_0_8_1|1_255_2_255_3_255_11_255_12_255_13_255_4_-1_6_1004_7_1_15_1_18_0_8_1|,kA13,0,kA15,0,kA16,0,kA14,,kA6,10,kA7,18,kA25,0,kA17,1,kA18,0,kS39,0,kA2,0,kA3,0,kA8,0,kA4,0,kA9,0,kA10,0,kA22,0,kA23,0,kA24,0,kA27,1,kA40,1,kA41,1,kA42,1,kA28,0,kA29,0,kA31,1,kA32,1,kA36,0,kA43,0,kA44,0,kA45,1,kA46,0,kA33,1,kA34,1,kA35,0,kA37,1,kA38,1,kA39,1,kA19,0,kA26,0,kA20,0,kA21,0,kA11,0;1,2066,2,-15,3,165,155,1,36,1,148,0.98;1,1935,2,-15,3,135,155,1,13,1,36,1,120,1.16;1,8,2,345,3,-15,155,2;"
 
+// Same as level_string_base, but channels 1001 and 1009 copy channel 1000 (key 9)
+// so a single colour trigger recolours all three
+#define level_string_base_linked_bg "kS38,1_63_2_184_3_199_11_255_12_255_13_255_4_-1_6_1000_7_1_15_1_18_0_8_1|1_63_2_184_3_199_11_255_12_255_13_255_4_-1_6_1001_7_1_15_1_18_0_8_1_9_1000|1_63_2_184_3_199_11_255_12_255_13_255_4_-1_6_1009_7_1_15_1_18_0_8_1_9_1000|1_255_2_255_3_255_11_255_12_255_13_255_4_-1_6_1002_5_1_7_1_15_1_18_0_8_1|1_40_2_125_3_255_11_255_12_255_13_255_4_-1_6_1013_7_1_15_1_18_0_8_1|1_40_2_125_3_255_11_255_12_255_13_255_4_-1_6_1014_7_1_15_1_18_0_8_1|1_255_2_0_3_255_11_255_12_255_13_255_4_-1_6_1005_5_1_7_1_15_1_18_0_8_1|1_0_2_0_3_255_11_255_12_255_13_255_4_-1_6_1006_5_1_7_1_15_1_18_0_8_1|1_255_2_255_3_255_11_255_12_255_13_255_4_-1_6_1004_7_1_15_1_18_0_8_1|,kA13,0,kA15,0,kA16,0,kA14,,kA6,10,kA7,18,kA25,0,kA17,1,kA18,0,kS39,0,kA2,0,kA3,0,kA8,0,kA4,0,kA9,0,kA10,0,kA22,0,kA23,0,kA24,0,kA27,1,kA40,1,kA41,1,kA42,1,kA28,0,kA29,0,kA31,1,kA32,1,kA36,0,kA43,0,kA44,0,kA45,1,kA46,0,kA33,1,kA34,1,kA35,0,kA37,1,kA38,1,kA39,1,kA19,0,kA26,0,kA20,0,kA21,0,kA11,0;1,2066,2,-15,3,165,155,1,36,1,148,0.98;1,1935,2,-15,3,135,155,1,13,1,36,1,120,1.16;1,8,2,345,3,-15,155,2;"
+
 #endif
 
 //24 = blocks fall, 23 = blocks rise
\ No newline at end of file
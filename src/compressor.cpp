@@ -0,0 +1,251 @@
+#include "compressor.hpp"
+#include "import_trace.hpp"
+
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <utility>
+#include <zlib.h>
+
+namespace {
+    // deflate's window; a chunk can back-reference this much of the last one
+    constexpr size_t DICTIONARY_SIZE = 32 * 1024;
+    
+    // gzip member header: magic, deflate, no flags, no mtime, no extra flags,
+    // unknown OS
+    constexpr uint8_t GZIP_HEADER[] = { 0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff };
+    
+    constexpr char BASE64_URL_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+    
+    void encodeTriplet(std::string& out, uint8_t a, uint8_t b, uint8_t c) {
+        uint32_t bits = (static_cast<uint32_t>(a) << 16) | (static_cast<uint32_t>(b) << 8) | c;
+        out.push_back(BASE64_URL_ALPHABET[(bits >> 18) & 0x3f]);
+        out.push_back(BASE64_URL_ALPHABET[(bits >> 12) & 0x3f]);
+        out.push_back(BASE64_URL_ALPHABET[(bits >> 6) & 0x3f]);
+        out.push_back(BASE64_URL_ALPHABET[bits & 0x3f]);
+    }
+}
+
+struct ChunkedCompressor::Job {
+    std::string input;
+    std::string dictionary;
+    std::string output;
+    size_t inputSize = 0;
+    uint32_t crc = 0;
+    bool last = false;
+    bool ok = true;
+    ImportTrace* trace = nullptr;
+    std::promise<void> done;
+    std::future<void> finished = done.get_future();
+    
+    // Always fulfils the promise, even if compressing throws, so drainOldest
+    // and the destructor can't wait forever; a failure just clears ok
+    void run() {
+        try {
+            compress();
+        } catch (...) {
+            ok = false;
+        }
+        
+        // The input is no longer needed once compressed; free it now rather
+        // than when the job is drained
+        std::string().swap(input);
+        std::string().swap(dictionary);
+        done.set_value();
+    }
+    
+    void compress() {
+        TraceScope chunkTrace(trace, "deflate chunk");
+        chunkTrace.setBytes(input.size());
+        
+        inputSize = input.size();
+        crc = crc32(0, reinterpret_cast<const Bytef*>(input.data()), static_cast<uInt>(input.size()));
+        
+        z_stream stream {};
+        if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            ok = false;
+            return;
+        }
+        if (!dictionary.empty()) {
+            deflateSetDictionary(&stream, reinterpret_cast<const Bytef*>(dictionary.data()), static_cast<uInt>(dictionary.size()));
+        }
+        
+        int status;
+        size_t produced = 0;
+        try {
+            // deflateBound doesn't count the empty stored block a sync flush
+            // appends, so leave room for it
+            output.resize(deflateBound(&stream, static_cast<uLong>(input.size())) + 16);
+            stream.next_in = reinterpret_cast<Bytef*>(input.data());
+            stream.avail_in = static_cast<uInt>(input.size());
+            
+            int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+            do {
+                if (produced == output.size()) output.resize(output.size() * 2);
+                stream.next_out = reinterpret_cast<Bytef*>(output.data() + produced);
+                stream.avail_out = static_cast<uInt>(output.size() - produced);
+                status = deflate(&stream, flush);
+                produced = output.size() - stream.avail_out;
+            } while (status == Z_OK && stream.avail_out == 0);
+        } catch (...) {
+            deflateEnd(&stream);
+            throw;
+        }
+        
+        ok = status == (last ? Z_STREAM_END : Z_OK);
+        output.resize(produced);
+        deflateEnd(&stream);
+    }
+};
+
+ChunkedCompressor::ChunkedCompressor(Executor executor, size_t chunkSize, size_t maxInFlight, ImportTrace* trace)
+    : m_executor(std::move(executor)), m_trace(trace), m_chunkSize(chunkSize), m_maxInFlight(maxInFlight) {
+    if (m_maxInFlight == 0) {
+        m_maxInFlight = std::max(2u, std::thread::hardware_concurrency());
+    }
+    m_pending.reserve(m_chunkSize);
+    encode(GZIP_HEADER, sizeof(GZIP_HEADER));
+}
+
+ChunkedCompressor::~ChunkedCompressor() {
+    // Jobs still running on the executor reference their own state only, but
+    // wait for them anyway so nothing outlives the compressor
+    for (auto& job : m_jobs) job->finished.wait();
+}
+
+void ChunkedCompressor::encode(const uint8_t* data, size_t length) {
+    size_t i = 0;
+    while (m_base64CarryLength > 0 && m_base64CarryLength < 3 && i < length) {
+        if (m_base64CarryLength == 2) {
+            encodeTriplet(m_output, m_base64Carry[0], m_base64Carry[1], data[i++]);
+            m_base64CarryLength = 0;
+        } else {
+            m_base64Carry[m_base64CarryLength++] = data[i++];
+        }
+    }
+    
+    m_output.reserve(m_output.size() + (length - i) / 3 * 4 + 4);
+    for (; i + 3 <= length; i += 3) {
+        encodeTriplet(m_output, data[i], data[i + 1], data[i + 2]);
+    }
+    for (; i < length; i++) {
+        m_base64Carry[m_base64CarryLength++] = data[i];
+    }
+}
+
+void ChunkedCompressor::write(std::string_view data) {
+    while (!data.empty()) {
+        size_t take = std::min(data.size(), m_chunkSize - m_pending.size());
+        m_pending.append(data.substr(0, take));
+        data.remove_prefix(take);
+        if (m_pending.size() == m_chunkSize) submit(false);
+    }
+}
+
+void ChunkedCompressor::submit(bool last) {
+    auto job = std::make_shared<Job>();
+    job->last = last;
+    job->trace = m_trace;
+    job->dictionary = std::move(m_dictionary);
+    
+    size_t tail = std::min(m_pending.size(), DICTIONARY_SIZE);
+    m_dictionary.assign(m_pending, m_pending.size() - tail, tail);
+    
+    job->input = std::move(m_pending);
+    m_pending = std::string();
+    if (!last) m_pending.reserve(m_chunkSize);
+    
+    // The last chunk runs inline; the caller would only be waiting otherwise.
+    // The job is only tracked once it's scheduled, so one the executor
+    // couldn't take is never waited on
+    if (m_executor && !last) {
+        m_executor([job] { job->run(); });
+    } else {
+        job->run();
+    }
+    m_jobs.push_back(job);
+    
+    while (m_jobs.size() > m_maxInFlight) drainOldest();
+}
+
+void ChunkedCompressor::drainOldest() {
+    auto job = std::move(m_jobs.front());
+    m_jobs.pop_front();
+    job->finished.wait();
+    
+    if (!job->ok) m_failed = true;
+    m_crc = crc32_combine(m_crc, job->crc, static_cast<z_off_t>(job->inputSize));
+    m_inputSize += static_cast<uint32_t>(job->inputSize);
+    encode(reinterpret_cast<const uint8_t*>(job->output.data()), job->output.size());
+}
+
+std::optional<std::string> ChunkedCompressor::finish() {
+    submit(true);
+    while (!m_jobs.empty()) drainOldest();
+    
+    uint8_t trailer[8];
+    for (int i = 0; i < 4; i++) {
+        trailer[i] = static_cast<uint8_t>(m_crc >> (8 * i));
+        trailer[4 + i] = static_cast<uint8_t>(m_inputSize >> (8 * i));
+    }
+    encode(trailer, sizeof(trailer));
+    
+    if (m_failed) return std::nullopt;
+    
+    if (m_base64CarryLength > 0) {
+        uint8_t b = m_base64CarryLength > 1 ? m_base64Carry[1] : 0;
+        encodeTriplet(m_output, m_base64Carry[0], b, 0);
+        m_output.resize(m_output.size() - (3 - m_base64CarryLength));
+        m_output.append(3 - m_base64CarryLength, '=');
+        m_base64CarryLength = 0;
+    }
+    
+    return std::move(m_output);
+}
+
+std::optional<std::string> buildCompressedObjectString(
+    Level const& inLevel, EmitOptions const& options, ChunkedCompressor::Executor executor,
+    ImportProgress* progress, ImportTrace* trace
+) {
+    TraceScope stageTrace(trace, "emit and compress");
+    size_t uncompressedSize = 0;
+    
+    // Progress is measured against the size estimate, so it's approximate
+    size_t expectedSize = 0;
+    if (progress) {
+        progress->setStage(ImportProgress::Stage::Converting);
+        expectedSize = std::max<size_t>(estimateObjectStringSize(inLevel), 1);
+    }
+    
+    // The serial emitter can't be interrupted, but once cancelled there's no
+    // point compressing the rest of what it writes
+    ChunkedCompressor compressor(executor, ChunkedCompressor::DEFAULT_CHUNK_SIZE, 0, trace);
+    auto compress = [&](std::string_view data) {
+        if (progress && progress->cancelled()) return;
+        uncompressedSize += data.size();
+        compressor.write(data);
+        if (progress) progress->setFraction(std::min(1.f, static_cast<float>(uncompressedSize) / expectedSize));
+    };
+    
+    // Running out of memory partway through a huge level fails the
+    // conversion rather than the caller
+    size_t records = 0;
+    try {
+        if (executor) {
+            records = emitObjectStringParallel(inLevel, options, executor, compress, 0, progress, trace);
+        }
+        else {
+            ObjectWriter writer(ChunkedCompressor::DEFAULT_CHUNK_SIZE, compress);
+            emitObjectString(inLevel, writer, options);
+            writer.flush();
+            records = writer.records();
+        }
+    } catch (...) {
+        return std::nullopt;
+    }
+    
+    stageTrace.setObjects(records);
+    stageTrace.setBytes(uncompressedSize);
+    if (progress && progress->cancelled()) return std::nullopt;
+    return compressor.finish();
+}
@@ -0,0 +1,80 @@
+#ifndef IG_COMPRESSOR
+#define IG_COMPRESSOR
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "emitter.hpp"
+#include "import_progress.hpp"
+#include "import_trace.hpp"
+#include "level.hpp"
+
+// Streaming equivalent of ZipUtils::compressString(str, false, 0): gzip then
+// URL-safe base64. Input is cut into fixed-size chunks which are deflated
+// independently (each primed with the tail of the previous chunk, like pigz)
+// and joined into a single gzip member, so chunks can be compressed in
+// parallel and only a bounded number of them are held in memory at once.
+class ChunkedCompressor {
+    public:
+    // Runs a job somewhere, eventually. Without an executor every chunk is
+    // compressed on the calling thread.
+    using Executor = JobExecutor;
+    
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 128 * 1024;
+    
+    private:
+    struct Job;
+    
+    Executor m_executor;
+    ImportTrace* m_trace;
+    size_t m_chunkSize;
+    size_t m_maxInFlight;
+    std::string m_pending;
+    std::string m_dictionary;
+    std::deque<std::shared_ptr<Job>> m_jobs;
+    
+    std::string m_output;
+    uint8_t m_base64Carry[2] = {};
+    size_t m_base64CarryLength = 0;
+    uint32_t m_crc = 0;
+    uint32_t m_inputSize = 0;
+    bool m_failed = false;
+    
+    void submit(bool last);
+    void drainOldest();
+    void encode(const uint8_t* data, size_t length);
+    
+    public:
+    // With a trace, each chunk is recorded in it
+    explicit ChunkedCompressor(
+        Executor executor = nullptr, size_t chunkSize = DEFAULT_CHUNK_SIZE, size_t maxInFlight = 0, ImportTrace* trace = nullptr
+    );
+    ~ChunkedCompressor();
+    
+    ChunkedCompressor(ChunkedCompressor const&) = delete;
+    ChunkedCompressor& operator=(ChunkedCompressor const&) = delete;
+    
+    void write(std::string_view data);
+    // Returns nullopt if zlib failed on any chunk
+    std::optional<std::string> finish();
+};
+
+// Emits the level's object string and compresses it as it's produced, so the
+// full uncompressed string never exists in memory. With an executor, emitting
+// is split across it too (see emitObjectStringParallel).
+//
+// Returns nullopt if emitting or compressing failed. With progress, reports
+// the Converting stage as it goes and gives up (also returning nullopt) soon
+// after it's cancelled. With a trace, records the whole stage and each slice
+// and chunk in it.
+std::optional<std::string> buildCompressedObjectString(
+    Level const& inLevel, EmitOptions const& options = {}, ChunkedCompressor::Executor executor = nullptr,
+    ImportProgress* progress = nullptr, ImportTrace* trace = nullptr
+);
+
+#endif
@@ -0,0 +1,143 @@
+#include "conversion_cache.hpp"
+#include "hash.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <vector>
+
+namespace {
+    constexpr std::string_view ENTRY_EXTENSION = ".txt";
+}
+
+ConversionCache::ConversionCache(std::filesystem::path directory, uintmax_t maxBytes)
+    : m_directory(std::move(directory)), m_maxBytes(maxBytes) {
+    std::error_code ec;
+    std::filesystem::create_directories(m_directory, ec);
+}
+
+uint64_t ConversionCache::keyFor(std::span<const std::byte> levelData, EmitOptions const& options, uint64_t extraHash) {
+    uint64_t seed = CONVERTER_VERSION;
+    seed = seed * 2 + options.compactGeometry;
+    seed = seed * 2 + options.coalesceTriggers;
+    seed = seed * 2 + options.sortByX;
+    return hashBytes(levelData, hashMix(seed) ^ extraHash);
+}
+
+std::filesystem::path ConversionCache::entryPath(uint64_t key) const {
+    char name[16];
+    auto end = std::to_chars(name, name + sizeof(name), key, 16).ptr;
+    return m_directory / (std::string(name, end) + std::string(ENTRY_EXTENSION));
+}
+
+std::optional<std::string> ConversionCache::load(uint64_t key) {
+    std::filesystem::path path;
+    {
+        std::lock_guard lock(m_mutex);
+        path = entryPath(key);
+    }
+    
+    // Read without the lock so one import's hit doesn't hold up the others.
+    // An entry evicted or replaced meanwhile is either still readable through
+    // the open handle or fails to open, which is just a miss.
+    std::string levelString;
+    {
+        std::ifstream stream(path, std::ios::binary | std::ios::ate);
+        if (!stream) return std::nullopt;
+        
+        auto size = static_cast<std::streamoff>(stream.tellg());
+        if (size <= 0) return std::nullopt;
+        
+        levelString.resize(static_cast<size_t>(size));
+        stream.seekg(0);
+        if (!stream.read(levelString.data(), size)) return std::nullopt;
+    }
+    
+    // Mark as recently used
+    std::lock_guard lock(m_mutex);
+    std::error_code ec;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+    return levelString;
+}
+
+void ConversionCache::store(uint64_t key, std::string_view levelString) {
+    std::lock_guard lock(m_mutex);
+    
+    if (levelString.size() > m_maxBytes) return;
+    
+    // Written to a temporary name first so a crash mid-write can't leave a
+    // truncated entry behind
+    auto path = entryPath(key);
+    auto temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+        if (!stream) return;
+        stream.write(levelString.data(), static_cast<std::streamsize>(levelString.size()));
+        if (!stream) return;
+    }
+    
+    if (!m_totalBytes) m_totalBytes = measure();
+    
+    // Replacing an entry (another import of the same level racing this one)
+    // frees the old one's size
+    std::error_code ec;
+    auto replaced = std::filesystem::file_size(path, ec);
+    if (ec) replaced = 0;
+    
+    std::filesystem::rename(temporary, path, ec);
+    if (ec) {
+        std::filesystem::remove(temporary, ec);
+        return;
+    }
+    
+    *m_totalBytes = *m_totalBytes - std::min(*m_totalBytes, replaced) + levelString.size();
+    if (*m_totalBytes > m_maxBytes) evict();
+}
+
+uintmax_t ConversionCache::measure() {
+    uintmax_t total = 0;
+    std::error_code ec;
+    for (auto const& file : std::filesystem::directory_iterator(m_directory, ec)) {
+        if (file.path().extension() != ENTRY_EXTENSION) continue;
+        auto size = file.file_size(ec);
+        if (!ec) total += size;
+    }
+    return total;
+}
+
+// Also resyncs the in-memory total with what's actually on disk
+void ConversionCache::evict() {
+    struct Entry {
+        std::filesystem::path path;
+        std::filesystem::file_time_type lastUsed;
+        uintmax_t size;
+    };
+    
+    std::vector<Entry> entries;
+    uintmax_t total = 0;
+    std::error_code ec;
+    for (auto const& file : std::filesystem::directory_iterator(m_directory, ec)) {
+        if (file.path().extension() != ENTRY_EXTENSION) continue;
+        
+        auto size = file.file_size(ec);
+        if (ec) continue;
+        auto lastUsed = file.last_write_time(ec);
+        if (ec) continue;
+        
+        entries.push_back({ file.path(), lastUsed, size });
+        total += size;
+    }
+    
+    m_totalBytes = total;
+    if (total <= m_maxBytes) return;
+    
+    std::sort(entries.begin(), entries.end(), [](Entry const& a, Entry const& b) {
+        return a.lastUsed < b.lastUsed;
+    });
+    for (auto const& entry : entries) {
+        if (total <= m_maxBytes) break;
+        if (std::filesystem::remove(entry.path, ec)) total -= entry.size;
+    }
+    m_totalBytes = total;
+}
@@ -0,0 +1,45 @@
+#ifndef IG_CONVERSIONCACHE
+#define IG_CONVERSIONCACHE
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include "emitter.hpp"
+
+// On-disk cache of finished (compressed) level strings, keyed by the hash of
+// the source .lvl bytes, the converter version and the emit options. Each
+// entry is one file; its modification time doubles as the LRU timestamp, and
+// the oldest entries are evicted whenever the cache grows past its size cap.
+// The cache's total size is kept in memory, so the directory is only listed
+// once up front and again when something has to be evicted.
+class ConversionCache {
+    private:
+    std::filesystem::path m_directory;
+    uintmax_t m_maxBytes;
+    std::mutex m_mutex;
+    // Unknown until the first store
+    std::optional<uintmax_t> m_totalBytes;
+    
+    std::filesystem::path entryPath(uint64_t key) const;
+    uintmax_t measure();
+    void evict();
+    
+    public:
+    static constexpr uintmax_t DEFAULT_MAX_BYTES = 64 * 1024 * 1024;
+    
+    ConversionCache(std::filesystem::path directory, uintmax_t maxBytes = DEFAULT_MAX_BYTES);
+    
+    // extraHash covers anything besides the .lvl the output depends on, like
+    // its custom background textures
+    static uint64_t keyFor(std::span<const std::byte> levelData, EmitOptions const& options, uint64_t extraHash = 0);
+    
+    std::optional<std::string> load(uint64_t key);
+    void store(uint64_t key, std::string_view levelString);
+};
+
+#endif
@@ -0,0 +1,784 @@
+#include "emitter.hpp"
+#include "compat_defs.hpp"
+#include "import_trace.hpp"
+#include "optimizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+    // Longest decimal form of an int, including the sign
+    constexpr size_t MAX_INT_CHARS = 11;
+    
+    // Fixed keys trailing each object kind
+    constexpr std::string_view COLOR_TRIGGER_TAIL = ",155,1,35,1;";
+    constexpr std::string_view MIRROR_PORTAL_TAIL = ",3,45,135,1,155,2,36,1,116,1;";
+    constexpr std::string_view CAMERA_MIDDLE = ",3,2970,155,2,36,1,85,2,68,";
+    constexpr std::string_view BLOCKS_RISE_TAIL = ",3,2940,155,1,36,1,217,1;";
+    constexpr std::string_view BLOCKS_FALL_TAIL = ",3,2910,155,1,36,1,217,2;";
+    
+    // Typical record lengths, written out as sample records with a seven
+    // character x position. Used to size the output buffer up front; the
+    // writer still grows if a level has wider numbers than these.
+    constexpr size_t BLOCK_RECORD_ESTIMATE = std::string_view("1,8,2,-123456,3,1234,21,0,24,0;").size();
+    constexpr size_t COLOR_TRIGGER_RECORD_ESTIMATE = std::string_view("1,899,2,-123456,3,3000,7,255,8,255,9,255,10,0.25,23,1000,155,1,35,1;").size();
+    constexpr size_t MIRROR_PORTAL_RECORD_ESTIMATE = std::string_view("1,45,2,-123456,3,45,135,1,155,2,36,1,116,1;").size();
+    constexpr size_t CAMERA_RECORD_ESTIMATE = std::string_view("1,2015,2,-123456,3,2970,155,2,36,1,85,2,68,180;").size();
+    constexpr size_t RANGE_TRIGGER_RECORD_ESTIMATE = std::string_view("1,1915,2,-123456,3,2940,155,1,36,1,217,1;").size();
+    
+    struct BackgroundColor {
+        int red;
+        int green;
+        int blue;
+    };
+    
+    // TIG background palette, indexed by BackgroundChange::colorID
+    constexpr BackgroundColor BACKGROUND_PALETTE[] = {
+        { 63, 184, 199 },
+        { 236, 216, 50 },
+        { 83, 255, 83 },
+        { 178, 38, 227 },
+        { 241, 19, 242 },
+        { 0, 0, 0 },
+    };
+    constexpr int BACKGROUND_PALETTE_SIZE = sizeof(BACKGROUND_PALETTE) / sizeof(BACKGROUND_PALETTE[0]);
+    
+    int pitSegmentCount(BlockTable const& blocks, size_t i) {
+        return round(blocks.pitLength(i)/30) + 1;
+    }
+    
+    // How many GD objects block i turns into (see forEachBlockSegment)
+    size_t blockObjectCount(BlockTable const& blocks, size_t i) {
+        return blocks.types[i] == 2 ? std::max(pitSegmentCount(blocks, i), 0) : 1;
+    }
+    
+    size_t totalBlockObjectCount(BlockTable const& blocks) {
+        size_t count = 0;
+        for (size_t i = 0; i < blocks.size(); i++) count += blockObjectCount(blocks, i);
+        return count;
+    }
+    
+    // The GD objects one TIG block turns into: pits are split into one
+    // object per 30 units, everything else maps to a single object
+    template <class F>
+    void forEachBlockSegment(BlockTable const& blocks, size_t i, int gdId, F&& callback) {
+        gdObj tempGD;
+        tempGD.p1_id = gdId;
+        tempGD.p2_x = blocks.xs[i];
+        
+        if (blocks.types[i] != 2) {
+            tempGD.p3_y = blocks.ys[i];
+            callback(tempGD);
+        }
+        else {
+            int iterations = pitSegmentCount(blocks, i);
+            tempGD.p3_y = 0;
+            for (int j = 0; j < iterations; j++) {
+                callback(tempGD);
+                tempGD.p2_x += 30;
+            }
+        }
+    }
+    
+    // Every GD object for blocks [begin, end), in file order. gdId is the ID
+    // carried in from the blocks before the run.
+    template <class F>
+    void forEachBlockObject(BlockTable const& blocks, size_t begin, size_t end, int gdId, F&& callback) {
+        for (size_t i = begin; i < end; i++) {
+            gdId = gdIdForBlock(blocks.types[i], gdId);
+            forEachBlockSegment(blocks, i, gdId, callback);
+        }
+    }
+    
+    // Colour changes and gravity flips after coalescing, ready to be written
+    struct TriggerPlan {
+        std::pmr::vector<gdColorTrigger> colorChanges;
+        std::pmr::vector<int> gravityFlips;
+        
+        explicit TriggerPlan(std::pmr::memory_resource* resource) : colorChanges(resource), gravityFlips(resource) {}
+    };
+    
+    TriggerPlan planTriggers(Level const& inLevel, EmitOptions const& options) {
+        TriggerPlan plan(inLevel.resource());
+        
+        // Unknown colour IDs keep whatever the previous change set. Custom
+        // textures become their average colour if they were loaded.
+        plan.colorChanges.reserve(inLevel.getBackgroundCount());
+        gdColorTrigger tempCT;
+        for (auto const& change : inLevel.getBackgrounds()) {
+            if (change.customTexture && change.tint >= 0) {
+                tempCT.p7_red = (change.tint >> 16) & 0xff;
+                tempCT.p8_green = (change.tint >> 8) & 0xff;
+                tempCT.p9_blue = change.tint & 0xff;
+            }
+            else if (change.colorID >= 0 && change.colorID < BACKGROUND_PALETTE_SIZE) {
+                auto const& color = BACKGROUND_PALETTE[change.colorID];
+                tempCT.p7_red = color.red;
+                tempCT.p8_green = color.green;
+                tempCT.p9_blue = color.blue;
+            }
+            tempCT.p2_x = change.xPos + 165;
+            plan.colorChanges.push_back(tempCT);
+        }
+        
+        plan.gravityFlips.reserve(inLevel.getGravityCount());
+        for (auto const& flip : inLevel.getGravity()) {
+            plan.gravityFlips.push_back(flip.xPos + 165);
+        }
+        
+        if (options.coalesceTriggers) {
+            auto const& initial = BACKGROUND_PALETTE[0];
+            gdColorTrigger initialColor;
+            initialColor.p7_red = initial.red;
+            initialColor.p8_green = initial.green;
+            initialColor.p9_blue = initial.blue;
+            coalesceColorTriggers(plan.colorChanges, initialColor);
+            coalesceGravityFlips(plan.gravityFlips);
+        }
+        
+        return plan;
+    }
+    
+    void emitColorChanges(std::span<const gdColorTrigger> changes, ObjectWriter& writer, EmitOptions const& options) {
+        for (auto trigger : changes) {
+            trigger.p3_y = 3000;
+            trigger.p23_channel = 1000;
+            writer.colorTrigger(trigger);
+            
+            // With coalescing, 1001 and 1009 copy 1000 from the level settings
+            if (options.coalesceTriggers) continue;
+            trigger.p3_y = 3030;
+            trigger.p23_channel = 1001;
+            writer.colorTrigger(trigger);
+            trigger.p3_y = 3060;
+            trigger.p23_channel = 1009;
+            writer.colorTrigger(trigger);
+        }
+    }
+    
+    // Flips alternate between inverting and restoring gravity, so whether a
+    // flip inverts only depends on its index in the whole list
+    void emitGravityFlips(std::span<const int> flips, size_t firstIndex, ObjectWriter& writer) {
+        gdMirrorPortal tempMP;
+        gdCameraObj tempCO;
+        bool currentlyInverted = firstIndex % 2 != 0;
+        for (int xPos : flips) {
+            tempMP.objID = currentlyInverted ? 46 : 45;
+            tempCO.rotation = currentlyInverted ? 0 : 180;
+            currentlyInverted = !currentlyInverted;
+            tempMP.xpos = xPos;
+            tempCO.xpos = xPos;
+            writer.mirrorPortal(tempMP);
+            writer.camera(tempCO);
+        }
+    }
+    
+    // Each rise or fall range becomes a start trigger and an end trigger. A
+    // range that ends where it starts runs to the end of the level.
+    gdBlocksRise riseTrigger(BlocksRise const& range, bool end, int endPos) {
+        gdBlocksRise trigger;
+        if (!end) {
+            trigger.id = 23;
+            trigger.xpos = range.startX - 465;
+        }
+        else {
+            trigger.id = 1915;
+            trigger.xpos = (range.startX == range.endX) ? endPos - 495 : range.endX - 495;
+        }
+        return trigger;
+    }
+    
+    gdBlocksFall fallTrigger(BlocksFall const& range, bool end, int endPos) {
+        gdBlocksFall trigger;
+        if (!end) {
+            trigger.id = 23;
+            trigger.xpos = range.startX - 135;
+        }
+        else {
+            trigger.id = 1915;
+            trigger.xpos = (range.startX == range.endX) ? endPos - 15 : range.endX - 15;
+        }
+        return trigger;
+    }
+    
+    void emitRising(std::span<const BlocksRise> rising, int endPos, ObjectWriter& writer) {
+        for (auto const& range : rising) {
+            writer.blocksRise(riseTrigger(range, false, endPos));
+            writer.blocksRise(riseTrigger(range, true, endPos));
+        }
+    }
+    
+    void emitFalling(std::span<const BlocksFall> falling, int endPos, ObjectWriter& writer) {
+        for (auto const& range : falling) {
+            writer.blocksFall(fallTrigger(range, false, endPos));
+            writer.blocksFall(fallTrigger(range, true, endPos));
+        }
+    }
+    
+    // Every block object in file order, or compacted (and so sorted by x)
+    std::pmr::vector<gdObj> collectBlockObjects(Level const& inLevel, EmitOptions const& options) {
+        std::pmr::vector<gdObj> objects(inLevel.resource());
+        objects.reserve(totalBlockObjectCount(inLevel.getBlocks()));
+        forEachBlockObject(inLevel.getBlocks(), 0, inLevel.getBlockCount(), gd_defblock, [&](gdObj const& obj) { objects.push_back(obj); });
+        if (options.compactGeometry) compactBlocks(objects);
+        return objects;
+    }
+    
+    // The x-sorted order is a merge of one stream per kind of object. A colour
+    // change's triggers and a gravity flip's portal and camera share an x, so
+    // each stays together as one entry.
+    enum class ObjectKind : uint8_t {
+        Block,
+        ColorChange,
+        GravityFlip,
+        RiseStart,
+        RiseEnd,
+        FallStart,
+        FallEnd,
+    };
+    constexpr size_t OBJECT_KIND_COUNT = 7;
+    
+    struct ObjectRef {
+        ObjectKind kind;
+        uint32_t index;
+    };
+    
+    struct SortedPlan {
+        std::pmr::vector<gdObj> blocks;
+        std::pmr::vector<ObjectRef> order;
+    };
+    
+    struct PlacedObject {
+        int x;
+        uint32_t index;
+    };
+    
+    SortedPlan planSortedObjects(Level const& inLevel, TriggerPlan const& triggers, EmitOptions const& options) {
+        auto resource = inLevel.resource();
+        SortedPlan plan { collectBlockObjects(inLevel, options), std::pmr::vector<ObjectRef>(resource) };
+        
+        std::pmr::vector<std::pmr::vector<PlacedObject>> streams(OBJECT_KIND_COUNT, resource);
+        auto stream = [&](ObjectKind kind) -> auto& { return streams[static_cast<size_t>(kind)]; };
+        
+        stream(ObjectKind::Block).reserve(plan.blocks.size());
+        for (size_t i = 0; i < plan.blocks.size(); i++) {
+            stream(ObjectKind::Block).push_back({ plan.blocks[i].p2_x, static_cast<uint32_t>(i) });
+        }
+        stream(ObjectKind::ColorChange).reserve(triggers.colorChanges.size());
+        for (size_t i = 0; i < triggers.colorChanges.size(); i++) {
+            stream(ObjectKind::ColorChange).push_back({ triggers.colorChanges[i].p2_x, static_cast<uint32_t>(i) });
+        }
+        stream(ObjectKind::GravityFlip).reserve(triggers.gravityFlips.size());
+        for (size_t i = 0; i < triggers.gravityFlips.size(); i++) {
+            stream(ObjectKind::GravityFlip).push_back({ triggers.gravityFlips[i], static_cast<uint32_t>(i) });
+        }
+        
+        int endPos = inLevel.getEndPos();
+        auto rising = inLevel.getRising();
+        stream(ObjectKind::RiseStart).reserve(rising.size());
+        stream(ObjectKind::RiseEnd).reserve(rising.size());
+        for (size_t i = 0; i < rising.size(); i++) {
+            stream(ObjectKind::RiseStart).push_back({ riseTrigger(rising[i], false, endPos).xpos, static_cast<uint32_t>(i) });
+            stream(ObjectKind::RiseEnd).push_back({ riseTrigger(rising[i], true, endPos).xpos, static_cast<uint32_t>(i) });
+        }
+        auto falling = inLevel.getFalling();
+        stream(ObjectKind::FallStart).reserve(falling.size());
+        stream(ObjectKind::FallEnd).reserve(falling.size());
+        for (size_t i = 0; i < falling.size(); i++) {
+            stream(ObjectKind::FallStart).push_back({ fallTrigger(falling[i], false, endPos).xpos, static_cast<uint32_t>(i) });
+            stream(ObjectKind::FallEnd).push_back({ fallTrigger(falling[i], true, endPos).xpos, static_cast<uint32_t>(i) });
+        }
+        
+        // Levels are built left to right, so streams usually come out sorted
+        // already and only need checking. Stable, so objects at the same x
+        // keep their file order.
+        size_t total = 0;
+        for (auto& placed : streams) {
+            auto byX = [](PlacedObject const& a, PlacedObject const& b) { return a.x < b.x; };
+            if (!std::is_sorted(placed.begin(), placed.end(), byX)) {
+                std::stable_sort(placed.begin(), placed.end(), byX);
+            }
+            total += placed.size();
+        }
+        
+        // With this few streams, scanning their heads beats keeping a heap.
+        // Ties go to the earlier kind, which is the order the unsorted output
+        // has them in.
+        plan.order.reserve(total);
+        std::array<size_t, OBJECT_KIND_COUNT> heads {};
+        while (plan.order.size() < total) {
+            size_t best = OBJECT_KIND_COUNT;
+            for (size_t kind = 0; kind < OBJECT_KIND_COUNT; kind++) {
+                if (heads[kind] == streams[kind].size()) continue;
+                if (best == OBJECT_KIND_COUNT || streams[kind][heads[kind]].x < streams[best][heads[best]].x) best = kind;
+            }
+            plan.order.push_back({ static_cast<ObjectKind>(best), streams[best][heads[best]++].index });
+        }
+        return plan;
+    }
+    
+    void emitSortedObjects(
+        std::span<const ObjectRef> refs, SortedPlan const& sorted, TriggerPlan const& triggers,
+        Level const& inLevel, ObjectWriter& writer, EmitOptions const& options
+    ) {
+        std::span<const gdColorTrigger> colorChanges = triggers.colorChanges;
+        std::span<const int> gravityFlips = triggers.gravityFlips;
+        auto rising = inLevel.getRising();
+        auto falling = inLevel.getFalling();
+        int endPos = inLevel.getEndPos();
+        
+        for (auto ref : refs) {
+            switch (ref.kind) {
+                case ObjectKind::Block:
+                    if (options.compactGeometry) writer.compactBlock(sorted.blocks[ref.index]);
+                    else writer.block(sorted.blocks[ref.index]);
+                    break;
+                case ObjectKind::ColorChange:
+                    emitColorChanges(colorChanges.subspan(ref.index, 1), writer, options);
+                    break;
+                case ObjectKind::GravityFlip:
+                    emitGravityFlips(gravityFlips.subspan(ref.index, 1), ref.index, writer);
+                    break;
+                case ObjectKind::RiseStart:
+                    writer.blocksRise(riseTrigger(rising[ref.index], false, endPos));
+                    break;
+                case ObjectKind::RiseEnd:
+                    writer.blocksRise(riseTrigger(rising[ref.index], true, endPos));
+                    break;
+                case ObjectKind::FallStart:
+                    writer.blocksFall(fallTrigger(falling[ref.index], false, endPos));
+                    break;
+                case ObjectKind::FallEnd:
+                    writer.blocksFall(fallTrigger(falling[ref.index], true, endPos));
+                    break;
+            }
+        }
+    }
+}
+
+int gdIdForBlock(int objType, int previousId) {
+    // Unknown types keep the previous block's ID
+    switch(objType) {
+        case 0: return gd_defblock;
+        case 1: return gd_spike;
+        case 2: return gd_pit;
+    }
+    return previousId;
+}
+
+void emitBlock(BlockTable const& blocks, size_t i, int gdId, ObjectWriter& writer) {
+    forEachBlockSegment(blocks, i, gdId, [&](gdObj const& obj) { writer.block(obj); });
+}
+
+std::string_view levelStringBase(EmitOptions const& options) {
+    return options.coalesceTriggers ? level_string_base_linked_bg : level_string_base;
+}
+
+// The buffer's size is its capacity; m_size tracks how much has been written.
+// Growing via resize_and_overwrite skips zero-filling space we're about to
+// overwrite anyway.
+static void growUninitialized(std::string& buffer, size_t size) {
+    buffer.resize_and_overwrite(size, [](char*, size_t count) { return count; });
+}
+
+ObjectWriter::ObjectWriter(size_t capacity) {
+    growUninitialized(m_buffer, capacity);
+}
+
+ObjectWriter::ObjectWriter(size_t capacity, Sink sink) : m_flushThreshold(capacity), m_sink(std::move(sink)) {
+    growUninitialized(m_buffer, capacity + MAX_INT_CHARS);
+}
+
+char* ObjectWriter::reserveTail(size_t count) {
+    if (m_buffer.size() - m_size < count) {
+        growUninitialized(m_buffer, std::max(m_buffer.size() * 2, m_size + count));
+    }
+    return m_buffer.data() + m_size;
+}
+
+void ObjectWriter::append(std::string_view text) {
+    char* tail = reserveTail(text.size());
+    std::memcpy(tail, text.data(), text.size());
+    m_size += text.size();
+}
+
+void ObjectWriter::append(int value) {
+    char* tail = reserveTail(MAX_INT_CHARS);
+    m_size = std::to_chars(tail, tail + MAX_INT_CHARS, value).ptr - m_buffer.data();
+}
+
+void ObjectWriter::endRecord() {
+    m_records++;
+    if (m_sink && m_size >= m_flushThreshold) flush();
+}
+
+void ObjectWriter::flush() {
+    if (m_size == 0) return;
+    m_sink(std::string_view(m_buffer.data(), m_size));
+    m_size = 0;
+}
+
+void ObjectWriter::block(gdObj const& obj) {
+    append("1,");
+    append(obj.p1_id);
+    append(",2,");
+    append(obj.p2_x);
+    append(",3,");
+    append(obj.p3_y);
+    append(",21,");
+    append(obj.p21_colorID);
+    append(",24,");
+    append(obj.p24_zLayer);
+    append(";");
+    endRecord();
+}
+
+void ObjectWriter::compactBlock(gdObj const& obj) {
+    append("1,");
+    append(obj.p1_id);
+    append(",2,");
+    append(obj.p2_x);
+    append(",3,");
+    append(obj.p3_y);
+    if (obj.p21_colorID != 0) {
+        append(",21,");
+        append(obj.p21_colorID);
+    }
+    if (obj.p24_zLayer != 0) {
+        append(",24,");
+        append(obj.p24_zLayer);
+    }
+    if (obj.p128_scaleX != 1) {
+        append(",128,");
+        append(obj.p128_scaleX);
+    }
+    append(";");
+    endRecord();
+}
+
+void ObjectWriter::colorTrigger(gdColorTrigger const& trigger) {
+    append("1,899,2,");
+    append(trigger.p2_x);
+    append(",3,");
+    append(trigger.p3_y);
+    append(",7,");
+    append(trigger.p7_red);
+    append(",8,");
+    append(trigger.p8_green);
+    append(",9,");
+    append(trigger.p9_blue);
+    append(",10,");
+    append(trigger.p10_duration);
+    append(",23,");
+    append(trigger.p23_channel);
+    append(COLOR_TRIGGER_TAIL);
+    endRecord();
+}
+
+void ObjectWriter::mirrorPortal(gdMirrorPortal const& portal) {
+    append("1,");
+    append(portal.objID);
+    append(",2,");
+    append(portal.xpos);
+    append(MIRROR_PORTAL_TAIL);
+    endRecord();
+}
+
+void ObjectWriter::camera(gdCameraObj const& camera) {
+    append("1,2015,2,");
+    append(camera.xpos);
+    append(CAMERA_MIDDLE);
+    append(camera.rotation);
+    append(";");
+    endRecord();
+}
+
+void ObjectWriter::blocksRise(gdBlocksRise const& trigger) {
+    append("1,");
+    append(trigger.id);
+    append(",2,");
+    append(trigger.xpos);
+    append(BLOCKS_RISE_TAIL);
+    endRecord();
+}
+
+void ObjectWriter::blocksFall(gdBlocksFall const& trigger) {
+    append("1,");
+    append(trigger.id);
+    append(",2,");
+    append(trigger.xpos);
+    append(BLOCKS_FALL_TAIL);
+    endRecord();
+}
+
+std::string ObjectWriter::finish() && {
+    m_buffer.resize(m_size);
+    return std::move(m_buffer);
+}
+
+size_t estimateObjectStringSize(Level const& inLevel) {
+    return std::string_view(level_string_base).size()
+        + totalBlockObjectCount(inLevel.getBlocks()) * BLOCK_RECORD_ESTIMATE
+        + inLevel.getBackgroundCount() * 3 * COLOR_TRIGGER_RECORD_ESTIMATE
+        + inLevel.getGravityCount() * (MIRROR_PORTAL_RECORD_ESTIMATE + CAMERA_RECORD_ESTIMATE)
+        + (inLevel.getRisingCount() + inLevel.getFallingCount()) * 2 * RANGE_TRIGGER_RECORD_ESTIMATE;
+}
+
+void emitBlocks(Level const& inLevel, ObjectWriter& writer, EmitOptions const& options) {
+    if (options.compactGeometry) {
+        for (auto const& obj : collectBlockObjects(inLevel, options)) writer.compactBlock(obj);
+    }
+    else {
+        forEachBlockObject(inLevel.getBlocks(), 0, inLevel.getBlockCount(), gd_defblock, [&](gdObj const& obj) { writer.block(obj); });
+    }
+}
+
+void emitTriggers(Level const& inLevel, ObjectWriter& writer, EmitOptions const& options) {
+    auto plan = planTriggers(inLevel, options);
+    emitColorChanges(plan.colorChanges, writer, options);
+    emitGravityFlips(plan.gravityFlips, 0, writer);
+    emitRising(inLevel.getRising(), inLevel.getEndPos(), writer);
+    emitFalling(inLevel.getFalling(), inLevel.getEndPos(), writer);
+}
+
+void emitObjectsByX(Level const& inLevel, ObjectWriter& writer, EmitOptions const& options) {
+    auto triggers = planTriggers(inLevel, options);
+    auto sorted = planSortedObjects(inLevel, triggers, options);
+    emitSortedObjects(sorted.order, sorted, triggers, inLevel, writer, options);
+}
+
+void emitObjectString(Level const& inLevel, ObjectWriter& writer, EmitOptions const& options) {
+    writer.append(levelStringBase(options));
+    if (options.sortByX) {
+        emitObjectsByX(inLevel, writer, options);
+        return;
+    }
+    emitBlocks(inLevel, writer, options);
+    emitTriggers(inLevel, writer, options);
+}
+
+std::string buildObjectString(Level const& inLevel, EmitOptions const& options) {
+    ObjectWriter writer(estimateObjectStringSize(inLevel));
+    emitObjectString(inLevel, writer, options);
+    return std::move(writer).finish();
+}
+
+namespace {
+    // One independently formatted piece of the object string
+    struct EmitSlice {
+        std::function<void(ObjectWriter&)> emit;
+        size_t sizeEstimate;
+    };
+    
+    struct SliceJob {
+        std::string output;
+        size_t records = 0;
+        // Set instead of output if formatting the slice threw
+        std::exception_ptr error;
+        std::promise<void> done;
+        std::future<void> finished = done.get_future();
+    };
+    
+    // Calls back with [begin, end) ranges of at most perSlice items
+    template <class F>
+    void forEachRange(size_t count, size_t perSlice, F&& callback) {
+        for (size_t begin = 0; begin < count; begin += perSlice) {
+            callback(begin, std::min(count, begin + perSlice));
+        }
+    }
+    
+    std::pmr::vector<EmitSlice> planSlices(Level const& inLevel, TriggerPlan const& plan, EmitOptions const& options) {
+        std::pmr::vector<EmitSlice> slices(inLevel.resource());
+        auto const& blocks = inLevel.getBlocks();
+        
+        if (options.compactGeometry) {
+            // Compaction sorts and merges across the whole level, so the
+            // block section can't be split
+            slices.push_back({
+                [&inLevel, &options](ObjectWriter& writer) { emitBlocks(inLevel, writer, options); },
+                blocks.size() * BLOCK_RECORD_ESTIMATE
+            });
+        }
+        else {
+            // Cut by object count rather than block count, since one pit can
+            // be many objects. Each slice starts with the ID carried in from
+            // the blocks before it.
+            size_t begin = 0;
+            size_t objects = 0;
+            int startId = gd_defblock;
+            int gdId = gd_defblock;
+            for (size_t i = 0; i < blocks.size(); i++) {
+                gdId = gdIdForBlock(blocks.types[i], gdId);
+                objects += blockObjectCount(blocks, i);
+                if (objects >= PARALLEL_EMIT_SLICE_OBJECTS || i + 1 == blocks.size()) {
+                    slices.push_back({
+                        [&blocks, begin, end = i + 1, startId](ObjectWriter& writer) {
+                            forEachBlockObject(blocks, begin, end, startId, [&](gdObj const& obj) { writer.block(obj); });
+                        },
+                        objects * BLOCK_RECORD_ESTIMATE
+                    });
+                    begin = i + 1;
+                    objects = 0;
+                    startId = gdId;
+                }
+            }
+        }
+        
+        std::span<const gdColorTrigger> colorChanges = plan.colorChanges;
+        forEachRange(colorChanges.size(), PARALLEL_EMIT_SLICE_OBJECTS / 3, [&](size_t begin, size_t end) {
+            slices.push_back({
+                [run = colorChanges.subspan(begin, end - begin), &options](ObjectWriter& writer) {
+                    emitColorChanges(run, writer, options);
+                },
+                (end - begin) * 3 * COLOR_TRIGGER_RECORD_ESTIMATE
+            });
+        });
+        
+        std::span<const int> gravityFlips = plan.gravityFlips;
+        forEachRange(gravityFlips.size(), PARALLEL_EMIT_SLICE_OBJECTS / 2, [&](size_t begin, size_t end) {
+            slices.push_back({
+                [run = gravityFlips.subspan(begin, end - begin), begin](ObjectWriter& writer) {
+                    emitGravityFlips(run, begin, writer);
+                },
+                (end - begin) * (MIRROR_PORTAL_RECORD_ESTIMATE + CAMERA_RECORD_ESTIMATE)
+            });
+        });
+        
+        int endPos = inLevel.getEndPos();
+        auto rising = inLevel.getRising();
+        forEachRange(rising.size(), PARALLEL_EMIT_SLICE_OBJECTS / 2, [&](size_t begin, size_t end) {
+            slices.push_back({
+                [run = rising.subspan(begin, end - begin), endPos](ObjectWriter& writer) {
+                    emitRising(run, endPos, writer);
+                },
+                (end - begin) * 2 * RANGE_TRIGGER_RECORD_ESTIMATE
+            });
+        });
+        
+        auto falling = inLevel.getFalling();
+        forEachRange(falling.size(), PARALLEL_EMIT_SLICE_OBJECTS / 2, [&](size_t begin, size_t end) {
+            slices.push_back({
+                [run = falling.subspan(begin, end - begin), endPos](ObjectWriter& writer) {
+                    emitFalling(run, endPos, writer);
+                },
+                (end - begin) * 2 * RANGE_TRIGGER_RECORD_ESTIMATE
+            });
+        });
+        
+        return slices;
+    }
+    
+    // Sorted output has no sections to cut along, so it's cut into runs of
+    // the merged order instead
+    std::pmr::vector<EmitSlice> planSortedSlices(
+        Level const& inLevel, TriggerPlan const& triggers, SortedPlan const& sorted, EmitOptions const& options
+    ) {
+        std::pmr::vector<EmitSlice> slices(inLevel.resource());
+        std::span<const ObjectRef> order = sorted.order;
+        size_t expectedSize = estimateObjectStringSize(inLevel);
+        forEachRange(order.size(), PARALLEL_EMIT_SLICE_OBJECTS, [&](size_t begin, size_t end) {
+            slices.push_back({
+                [run = order.subspan(begin, end - begin), &sorted, &triggers, &inLevel, &options](ObjectWriter& writer) {
+                    emitSortedObjects(run, sorted, triggers, inLevel, writer, options);
+                },
+                expectedSize / order.size() * (end - begin)
+            });
+        });
+        return slices;
+    }
+}
+
+size_t emitObjectStringParallel(
+    Level const& inLevel, EmitOptions const& options, JobExecutor const& executor,
+    ObjectWriter::Sink const& sink, size_t maxInFlight, ImportProgress const* progress,
+    ImportTrace* trace
+) {
+    if (maxInFlight == 0) {
+        maxInFlight = std::max(2u, std::thread::hardware_concurrency() * 2);
+    }
+    
+    // The slices point into the plan and the level, so every job has to be
+    // waited on before returning
+    auto plan = planTriggers(inLevel, options);
+    std::optional<SortedPlan> sorted;
+    if (options.sortByX) sorted = planSortedObjects(inLevel, plan, options);
+    auto slices = sorted ? planSortedSlices(inLevel, plan, *sorted, options) : planSlices(inLevel, plan, options);
+    
+    sink(levelStringBase(options));
+    
+    size_t records = 0;
+    bool stopped = false;
+    std::exception_ptr error;
+    std::deque<std::shared_ptr<SliceJob>> inFlight;
+    auto drainOldest = [&] {
+        auto job = std::move(inFlight.front());
+        inFlight.pop_front();
+        job->finished.wait();
+        if (job->error && !error) {
+            error = job->error;
+            stopped = true;
+        }
+        if (stopped) return;
+        records += job->records;
+        sink(job->output);
+    };
+    
+    try {
+        for (auto& slice : slices) {
+            if (stopped || (progress && progress->cancelled())) {
+                stopped = true;
+                break;
+            }
+            if (inFlight.size() >= maxInFlight) drainOldest();
+            
+            // Always signals, even if formatting throws, so nothing waiting
+            // on the job can hang and nothing escapes onto the executor
+            auto job = std::make_shared<SliceJob>();
+            inFlight.push_back(job);
+            auto run = [job, &slice, trace] {
+                try {
+                    TraceScope sliceTrace(trace, "emit slice");
+                    ObjectWriter writer(slice.sizeEstimate + 64);
+                    slice.emit(writer);
+                    job->records = writer.records();
+                    sliceTrace.setObjects(job->records);
+                    job->output = std::move(writer).finish();
+                } catch (...) {
+                    job->error = std::current_exception();
+                }
+                job->done.set_value();
+            };
+            
+            if (executor) executor(std::move(run));
+            else run();
+        }
+        while (!inFlight.empty()) drainOldest();
+    } catch (...) {
+        // The sink threw; the jobs still running point into this frame
+        for (auto& job : inFlight) job->finished.wait();
+        throw;
+    }
+    
+    if (error) std::rethrow_exception(error);
+    return records;
+}
+
+std::string buildObjectString(Level const& inLevel, EmitOptions const& options, JobExecutor const& executor) {
+    if (!executor) return buildObjectString(inLevel, options);
+    
+    std::string result;
+    result.reserve(estimateObjectStringSize(inLevel));
+    emitObjectStringParallel(inLevel, options, executor, [&](std::string_view text) { result += text; });
+    return result;
+}
@@ -0,0 +1,120 @@
+#ifndef IG_EMITTER
+#define IG_EMITTER
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include "gdstructs.hpp"
+#include "import_progress.hpp"
+#include "import_trace.hpp"
+#include "level.hpp"
+
+// Appends GD object records to a single growable buffer. Numbers are written
+// with std::to_chars directly into the buffer, so emitting an object never
+// creates a temporary string.
+//
+// With a sink, the writer instead hands its contents to the sink whenever a
+// record takes it past the given capacity and starts over, so the buffer
+// never grows much past that.
+class ObjectWriter {
+    public:
+    using Sink = std::function<void(std::string_view)>;
+    
+    private:
+    std::string m_buffer;
+    size_t m_size = 0;
+    size_t m_records = 0;
+    size_t m_flushThreshold = 0;
+    Sink m_sink;
+    
+    char* reserveTail(size_t count);
+    void endRecord();
+    
+    public:
+    explicit ObjectWriter(size_t capacity);
+    ObjectWriter(size_t capacity, Sink sink);
+    
+    void append(std::string_view text);
+    void append(int value);
+    
+    void block(gdObj const& obj);
+    // Like block(), but leaves out keys at their default value
+    void compactBlock(gdObj const& obj);
+    void colorTrigger(gdColorTrigger const& trigger);
+    void mirrorPortal(gdMirrorPortal const& portal);
+    void camera(gdCameraObj const& camera);
+    void blocksRise(gdBlocksRise const& trigger);
+    void blocksFall(gdBlocksFall const& trigger);
+    
+    size_t size() const { return m_size; }
+    size_t records() const { return m_records; }
+    // Passes everything written so far to the sink
+    void flush();
+    std::string finish() &&;
+};
+
+// Runs a job somewhere, eventually
+using JobExecutor = std::function<void(std::function<void()>)>;
+
+// Bump whenever the emitted level string changes for the same input, so
+// cached conversions from older versions aren't reused
+constexpr uint32_t CONVERTER_VERSION = 1;
+
+struct EmitOptions {
+    // Run compactBlocks over the block and pit objects before writing them
+    bool compactGeometry = false;
+    // Run coalesceColorTriggers and coalesceGravityFlips, and link the ground
+    // colour channels to the background so one trigger sets all three
+    bool coalesceTriggers = false;
+    // Write all objects ordered by x rather than grouped by kind, so GD meets
+    // them in the order it places them into sections
+    bool sortByX = false;
+};
+
+// Expected length of buildObjectString's output for this level, used to size
+// the output buffer in one allocation
+size_t estimateObjectStringSize(Level const& inLevel);
+
+// The GD object ID a TIG block becomes. Blocks of unknown type reuse the ID
+// of the block before them.
+int gdIdForBlock(int objType, int previousId);
+// Writes the object(s) for one TIG block, without compaction
+void emitBlock(BlockTable const& blocks, size_t i, int gdId, ObjectWriter& writer);
+
+// A level string is the base (level settings and colour channels), then the
+// block objects, then the triggers; or with sortByX, the base and then
+// emitObjectsByX
+std::string_view levelStringBase(EmitOptions const& options);
+void emitBlocks(Level const& inLevel, ObjectWriter& writer, EmitOptions const& options = {});
+void emitTriggers(Level const& inLevel, ObjectWriter& writer, EmitOptions const& options = {});
+// The same objects emitBlocks and emitTriggers write, merged into x order.
+// Objects at the same x keep the unsorted output's order.
+void emitObjectsByX(Level const& inLevel, ObjectWriter& writer, EmitOptions const& options = {});
+
+void emitObjectString(Level const& inLevel, ObjectWriter& writer, EmitOptions const& options = {});
+std::string buildObjectString(Level const& inLevel, EmitOptions const& options = {});
+
+// Roughly how many objects each parallel emit job formats
+constexpr size_t PARALLEL_EMIT_SLICE_OBJECTS = 16 * 1024;
+
+// Same output as emitObjectString, but the level is cut into slices (runs of
+// consecutive blocks, then runs of each trigger kind, or runs of the x order
+// when sorting) which are formatted on the executor into separate buffers.
+// The sink gets each slice's text on the calling thread, in order. At most maxInFlight slices are held at once; 0
+// means two per hardware thread. Returns the number of objects written.
+//
+// If progress is cancelled, no more slices are started and the sink isn't
+// called again; the output is then incomplete. If a slice throws, the same
+// happens, and once every job has finished its exception is rethrown here.
+// With a trace, each slice is recorded in it.
+size_t emitObjectStringParallel(
+    Level const& inLevel, EmitOptions const& options, JobExecutor const& executor,
+    ObjectWriter::Sink const& sink, size_t maxInFlight = 0, ImportProgress const* progress = nullptr,
+    ImportTrace* trace = nullptr
+);
+// Without an executor this is the serial buildObjectString
+std::string buildObjectString(Level const& inLevel, EmitOptions const& options, JobExecutor const& executor);
+
+#endif
@@ -1,11 +1,36 @@
 #ifndef GD_STRUCTS
 #define GD_STRUCTS
 
-struct BlockObject {
-    int xPos;
-    int yPos; // Acts as endX for pits
-    int objType;
-    int indexInVec;
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Decoded blocks, one array per field. Positions are stored already moved
+// into GD space, which is where the emitter wants them.
+struct BlockTable {
+    static constexpr int X_OFFSET = -135;
+    static constexpr int Y_OFFSET = 15;
+    
+    std::pmr::vector<uint8_t> types;
+    std::pmr::vector<int32_t> xs; // TIG x + X_OFFSET
+    std::pmr::vector<int32_t> ys; // TIG y + Y_OFFSET; a pit's TIG y is its end x
+    
+    BlockTable() = default;
+    explicit BlockTable(std::pmr::memory_resource* resource) : types(resource), xs(resource), ys(resource) {}
+    
+    size_t size() const { return types.size(); }
+    
+    void resize(size_t count) {
+        types.resize(count);
+        xs.resize(count);
+        ys.resize(count);
+    }
+    
+    // A pit's TIG end x minus its TIG start x
+    int pitLength(size_t i) const { return (ys[i] - Y_OFFSET) - (xs[i] - X_OFFSET); }
 };
 
 struct BackgroundChange {
@@ -13,7 +38,10 @@ struct BackgroundChange {
     int colorID;
     const char* colorName;
     bool customTexture;
-    std::string filePath;
+    // Allocated from the owning Level's resource
+    std::pmr::string filePath;
+    // 0xRRGGBB stand-in colour for a custom texture, once it's been loaded
+    int tint = -1;
 };
 
 struct GravityChange {
@@ -30,63 +58,51 @@ struct BlocksFall {
     int endX;
 };
 
+// GD-side object fields. Only the keys that vary per object are stored; the
+// fixed keys each object carries are written by the emitter.
 struct gdObj
 {
-    std::string p1_id = "1"; //block is default, can be changed to spike or pit
-    std::string p2_x = "0";
-    std::string p3_y = "0";
-    std::string p21_colorID = "0";
-    std::string p24_zLayer = "0";
+    int p1_id = 1; //block is default, can be changed to spike or pit
+    int p2_x = 0;
+    int p3_y = 0;
+    int p21_colorID = 0;
+    int p24_zLayer = 0;
+    int p128_scaleX = 1; //only written when compacting, where runs get merged
 };
 
-
-
 struct gdColorTrigger
 {
-    std::string p1_id = "899";
-    std::string p2_x = "0";
-    std::string p3_y = "0";
-    std::string p7_red = "0";
-    std::string p8_green = "0";
-    std::string p9_blue = "0";
-    std::string p10_duration = "0.25";
-    std::string p23_channel = "1000";
-    std::string remainder = ",155,1,35,1";
+    int p2_x = 0;
+    int p3_y = 0;
+    int p7_red = 0;
+    int p8_green = 0;
+    int p9_blue = 0;
+    std::string_view p10_duration = "0.25";
+    int p23_channel = 1000;
 };
 
 struct gdCameraObj
 {
-    std::string base = "1,2015,2,";
-    std::string xpos = "0";
-    std::string middle = ",3,2970,155,2,36,1,85,2,68,";
-    std::string rotation = "180";
+    int xpos = 0;
+    int rotation = 180;
 };
 
 struct gdMirrorPortal
 {
-    std::string base = "1,";
-    std::string objID = "45"; //45 = mirror start, 46 = mirror end
-    std::string middle = ",2,";
-    std::string xpos = "15";
-    std::string remainder = ",3,45,135,1,155,2,36,1,116,1";
+    int objID = 45; //45 = mirror start, 46 = mirror end
+    int xpos = 15;
 };
 
 struct gdBlocksRise
 {
-    std::string base = "1,";
-    std::string id = "23"; //set to 1915 for endBlocksRise
-    std::string middle = ",2,";
-    std::string xpos = "15";
-    std::string remainder = ",3,2940,155,1,36,1,217,1";
+    int id = 23; //set to 1915 for endBlocksRise
+    int xpos = 15;
 };
 
 struct gdBlocksFall
 {
-    std::string base = "1,";
-    std::string id = "23"; //set to 1915 for endBlocksFall
-    std::string middle = ",2,";
-    std::string xpos = "15";
-    std::string remainder = ",3,2910,155,1,36,1,217,2";
+    int id = 23; //set to 1915 for endBlocksFall
+    int xpos = 15;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,42 @@
+#ifndef IG_HASH
+#define IG_HASH
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+// Fast non-cryptographic 64-bit hash, used to content-address level files.
+// Reads eight bytes per step and only mixes thoroughly at the end, so it runs
+// at close to memory speed on mapped files.
+inline uint64_t hashMix(uint64_t value) {
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ull;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebull;
+    value ^= value >> 31;
+    return value;
+}
+
+inline uint64_t hashBytes(std::span<const std::byte> data, uint64_t seed = 0) {
+    constexpr uint64_t MULTIPLIER = 0x9e3779b97f4a7c15ull;
+    
+    uint64_t hash = seed ^ (data.size() * MULTIPLIER);
+    size_t i = 0;
+    for (; i + 8 <= data.size(); i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data.data() + i, 8);
+        hash = (hash ^ (word * MULTIPLIER)) * MULTIPLIER;
+        hash ^= hash >> 29;
+    }
+    
+    if (i < data.size()) {
+        uint64_t tail = 0;
+        std::memcpy(&tail, data.data() + i, data.size() - i);
+        hash = (hash ^ (tail * MULTIPLIER)) * MULTIPLIER;
+    }
+    
+    return hashMix(hash);
+}
+
+#endif
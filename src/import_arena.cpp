@@ -0,0 +1,31 @@
+#include "import_arena.hpp"
+
+#include <algorithm>
+
+void* ImportArena::HeapCounter::do_allocate(size_t bytes, size_t alignment) {
+    allocations++;
+    this->bytes += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void ImportArena::HeapCounter::do_deallocate(void* ptr, size_t bytes, size_t alignment) {
+    std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+}
+
+// monotonic_buffer_resource rejects a zero initial size
+ImportArena::ImportArena(size_t initialSize) : m_arena(std::max<size_t>(initialSize, 1), &m_heap) {}
+
+void* ImportArena::do_allocate(size_t bytes, size_t alignment) {
+    std::lock_guard lock(m_mutex);
+    m_stats.allocations++;
+    m_stats.bytes += bytes;
+    return m_arena.allocate(bytes, alignment);
+}
+
+ImportArena::Stats ImportArena::stats() const {
+    std::lock_guard lock(m_mutex);
+    auto stats = m_stats;
+    stats.heapAllocations = m_heap.allocations;
+    stats.heapBytes = m_heap.bytes;
+    return stats;
+}
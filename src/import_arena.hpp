@@ -0,0 +1,59 @@
+#ifndef IG_IMPORTARENA
+#define IG_IMPORTARENA
+
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+
+// Memory for one import. What the parser and emitter keep for the length of a
+// conversion (the block table, background paths, trigger lists, slice plans)
+// is bump-allocated from one monotonic buffer and released in a single step
+// when the arena goes away; individual frees are no-ops.
+//
+// Allocation is locked, since the parallel emitter's slices may allocate from
+// the level's resource on pool threads. It also counts what it hands out and
+// what it had to take from the heap to do so, which is how an import shows
+// that its hot path isn't allocating.
+class ImportArena : public std::pmr::memory_resource {
+    public:
+    struct Stats {
+        size_t allocations = 0;
+        size_t bytes = 0;
+        // Buffers the arena itself took from the heap
+        size_t heapAllocations = 0;
+        size_t heapBytes = 0;
+    };
+    
+    private:
+    class HeapCounter : public std::pmr::memory_resource {
+        public:
+        size_t allocations = 0;
+        size_t bytes = 0;
+        
+        private:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+        bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override { return this == &other; }
+    };
+    
+    mutable std::mutex m_mutex;
+    HeapCounter m_heap;
+    std::pmr::monotonic_buffer_resource m_arena;
+    Stats m_stats;
+    
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override { return this == &other; }
+    
+    public:
+    // A decoded level takes about as much memory as its file, so the file's
+    // size makes a good first buffer; the arena grows past it if needed
+    explicit ImportArena(size_t initialSize = 64 * 1024);
+    
+    ImportArena(ImportArena const&) = delete;
+    ImportArena& operator=(ImportArena const&) = delete;
+    
+    Stats stats() const;
+};
+
+#endif
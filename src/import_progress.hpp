@@ -0,0 +1,51 @@
+#ifndef IG_IMPORTPROGRESS
+#define IG_IMPORTPROGRESS
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Shared between an import running on the blocking pool and the UI showing
+// it. The import reports which stage it's in and how far through it is; the
+// UI polls that, and can ask the import to stop, which it notices at the next
+// stage boundary or emit slice. Everything is a lone atomic, so neither side
+// ever waits on the other.
+class ImportProgress {
+    public:
+    enum class Stage : uint8_t {
+        Scanning,
+        Parsing,
+        Backgrounds,
+        Converting, // emitting and compressing, which run interleaved
+        Finished,
+    };
+    
+    private:
+    std::atomic<Stage> m_stage = Stage::Scanning;
+    std::atomic<float> m_fraction = 0.f;
+    std::atomic<uint32_t> m_levelsDone = 0;
+    std::atomic<uint32_t> m_levelsTotal = 0;
+    std::atomic<bool> m_cancelled = false;
+    
+    public:
+    void setStage(Stage stage) {
+        m_stage.store(stage, std::memory_order_relaxed);
+        m_fraction.store(0.f, std::memory_order_relaxed);
+    }
+    // How far through the current stage, from 0 to 1
+    void setFraction(float fraction) { m_fraction.store(fraction, std::memory_order_relaxed); }
+    // Batch imports count whole levels instead
+    void setLevelsTotal(uint32_t total) { m_levelsTotal.store(total, std::memory_order_relaxed); }
+    void levelDone() { m_levelsDone.fetch_add(1, std::memory_order_relaxed); }
+    void finish() { m_stage.store(Stage::Finished, std::memory_order_relaxed); }
+    
+    Stage stage() const { return m_stage.load(std::memory_order_relaxed); }
+    float fraction() const { return m_fraction.load(std::memory_order_relaxed); }
+    uint32_t levelsDone() const { return m_levelsDone.load(std::memory_order_relaxed); }
+    uint32_t levelsTotal() const { return m_levelsTotal.load(std::memory_order_relaxed); }
+    
+    void cancel() { m_cancelled.store(true, std::memory_order_relaxed); }
+    bool cancelled() const { return m_cancelled.load(std::memory_order_relaxed); }
+};
+
+#endif
@@ -0,0 +1,131 @@
+#include "import_progress_popup.hpp"
+
+using namespace geode::prelude;
+
+namespace {
+    constexpr float POPUP_WIDTH = 260.f;
+    constexpr float POPUP_HEIGHT = 140.f;
+}
+
+ImportProgressPopup* ImportProgressPopup::create(std::shared_ptr<ImportProgress> progress) {
+    auto ret = new ImportProgressPopup();
+    if (ret->init(std::move(progress))) {
+        ret->autorelease();
+        return ret;
+    }
+    delete ret;
+    return nullptr;
+}
+
+bool ImportProgressPopup::init(std::shared_ptr<ImportProgress> progress) {
+    if (!this->initWithColor({ 0, 0, 0, 105 })) return false;
+    m_progress = std::move(progress);
+    m_noElasticity = true;
+    
+    auto winSize = CCDirector::get()->getWinSize();
+    CCPoint center { winSize.width / 2, winSize.height / 2 };
+    
+    m_mainLayer = CCLayer::create();
+    this->addChild(m_mainLayer);
+    
+    auto bg = CCScale9Sprite::create("GJ_square01.png", { 0, 0, 80, 80 });
+    bg->setContentSize({ POPUP_WIDTH, POPUP_HEIGHT });
+    bg->setPosition(center);
+    m_mainLayer->addChild(bg);
+    
+    auto title = CCLabelBMFont::create("Importing", "goldFont.fnt");
+    title->setScale(.8f);
+    title->setPosition(center + ccp(0, POPUP_HEIGHT / 2 - 22));
+    m_mainLayer->addChild(title);
+    
+    m_status = CCLabelBMFont::create("", "bigFont.fnt");
+    m_status->setScale(.4f);
+    m_status->setPosition(center + ccp(0, 14));
+    m_mainLayer->addChild(m_status);
+    
+    // Same construction as GD's own level progress bars: a darkened bar with
+    // a tinted copy inside it, cropped to the progress
+    auto bar = CCSprite::create("GJ_progressBar_001.png");
+    bar->setColor({ 0, 0, 0 });
+    bar->setOpacity(125);
+    bar->setScale(.6f);
+    bar->setPosition(center + ccp(0, -10));
+    m_mainLayer->addChild(bar);
+    
+    m_barFill = CCSprite::create("GJ_progressBar_001.png");
+    m_barFill->setColor({ 0, 255, 0 });
+    m_barFill->setScaleX(.992f);
+    m_barFill->setScaleY(.86f);
+    m_barFill->setAnchorPoint({ 0, .5f });
+    m_barSize = m_barFill->getTextureRect().size;
+    m_barFill->setPosition({ m_barSize.width * .004f, bar->getContentSize().height / 2 });
+    bar->addChild(m_barFill);
+    
+    m_buttonMenu = CCMenu::create();
+    m_buttonMenu->setPosition(center + ccp(0, -POPUP_HEIGHT / 2 + 25));
+    m_buttonMenu->addChild(CCMenuItemSpriteExtra::create(
+        ButtonSprite::create("Cancel"), this, menu_selector(ImportProgressPopup::onCancel)
+    ));
+    m_mainLayer->addChild(m_buttonMenu);
+    
+    this->setTouchEnabled(true);
+    this->setKeypadEnabled(true);
+    handleTouchPriority(this);
+    
+    // Only the update loop closes the popup, so it's never closed before it
+    // has been shown
+    this->updateStatus();
+    this->scheduleUpdate();
+    return true;
+}
+
+void ImportProgressPopup::update(float) {
+    if (m_progress->stage() == ImportProgress::Stage::Finished) {
+        this->close();
+        return;
+    }
+    this->updateStatus();
+}
+
+void ImportProgressPopup::updateStatus() {
+    std::string status;
+    float fraction = m_progress->fraction();
+    if (m_progress->cancelled()) {
+        status = "Cancelling...";
+    }
+    else if (auto total = m_progress->levelsTotal(); total > 0) {
+        auto done = m_progress->levelsDone();
+        status = fmt::format("Converting level {} of {}", std::min(done + 1, total), total);
+        fraction = static_cast<float>(done) / total;
+    }
+    else switch (m_progress->stage()) {
+        case ImportProgress::Stage::Scanning: status = "Finding levels..."; break;
+        case ImportProgress::Stage::Parsing: status = "Reading level..."; break;
+        case ImportProgress::Stage::Backgrounds: status = "Loading backgrounds..."; break;
+        case ImportProgress::Stage::Converting: status = fmt::format("Converting... {}%", static_cast<int>(fraction * 100)); break;
+        case ImportProgress::Stage::Finished: break;
+    }
+    
+    if (status != m_lastStatus) {
+        m_status->setString(status.c_str());
+        m_lastStatus = std::move(status);
+    }
+    m_barFill->setTextureRect({ 0, 0, m_barSize.width * std::clamp(fraction, 0.f, 1.f), m_barSize.height });
+}
+
+void ImportProgressPopup::keyBackClicked() {
+    this->onCancel(nullptr);
+}
+
+// The import notices at its next checkpoint and finishes with a cancelled
+// result, which closes the popup through finish() like any other ending
+void ImportProgressPopup::onCancel(CCObject*) {
+    m_progress->cancel();
+}
+
+void ImportProgressPopup::close() {
+    this->unscheduleUpdate();
+    this->setKeypadEnabled(false);
+    this->setTouchEnabled(false);
+    this->removeFromParentAndCleanup(true);
+}
@@ -0,0 +1,31 @@
+#ifndef IG_IMPORTPROGRESSPOPUP
+#define IG_IMPORTPROGRESSPOPUP
+
+#include <Geode/Geode.hpp>
+#include <memory>
+#include <string>
+#include "import_progress.hpp"
+
+// Modal progress display for a running import, with a Cancel button. Polls
+// the import's ImportProgress every frame and closes itself once the import
+// reports it's finished, so the import never has to touch the UI.
+class ImportProgressPopup : public FLAlertLayer {
+    protected:
+    std::shared_ptr<ImportProgress> m_progress;
+    cocos2d::CCLabelBMFont* m_status = nullptr;
+    cocos2d::CCSprite* m_barFill = nullptr;
+    cocos2d::CCSize m_barSize;
+    std::string m_lastStatus;
+    
+    bool init(std::shared_ptr<ImportProgress> progress);
+    void update(float) override;
+    void updateStatus();
+    void keyBackClicked() override;
+    void onCancel(cocos2d::CCObject*);
+    void close();
+    
+    public:
+    static ImportProgressPopup* create(std::shared_ptr<ImportProgress> progress);
+};
+
+#endif
@@ -0,0 +1,108 @@
+#include "import_trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <utility>
+
+namespace {
+    uint32_t currentThreadIndex() {
+        static std::atomic<uint32_t> nextIndex = 1;
+        thread_local uint32_t index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+}
+
+
+uint64_t ImportTrace::now() const {
+    auto elapsed = std::chrono::steady_clock::now() - m_origin;
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+void ImportTrace::record(Event const& event) {
+    std::lock_guard lock(m_mutex);
+    m_events.push_back(event);
+}
+
+std::vector<ImportTrace::Event> ImportTrace::takeEvents() {
+    std::lock_guard lock(m_mutex);
+    return std::exchange(m_events, {});
+}
+
+TraceScope::TraceScope(ImportTrace* trace, std::string_view name) : m_trace(trace), m_name(name) {
+    if (m_trace) m_start = m_trace->now();
+}
+
+TraceScope::~TraceScope() {
+    end();
+}
+
+void TraceScope::end() {
+    if (!m_trace) return;
+    uint64_t end = m_trace->now();
+    m_trace->record({ m_name, m_start, end - m_start, currentThreadIndex(), m_objects, m_bytes });
+    m_trace = nullptr;
+}
+
+std::string formatTraceSummary(std::vector<ImportTrace::Event> const& events) {
+    struct Totals {
+        uint64_t firstStart = UINT64_MAX;
+        size_t count = 0;
+        uint64_t micros = 0;
+        int64_t objects = 0;
+        int64_t bytes = 0;
+    };
+    
+    // Keyed by name, but listed in the order each phase first started
+    std::map<std::string_view, Totals> phases;
+    for (auto const& event : events) {
+        auto& totals = phases[event.name];
+        totals.firstStart = std::min(totals.firstStart, event.startMicros);
+        totals.count++;
+        totals.micros += event.durationMicros;
+        if (event.objects >= 0) totals.objects += event.objects;
+        if (event.bytes >= 0) totals.bytes += event.bytes;
+    }
+    
+    std::vector<std::pair<std::string_view, Totals>> ordered(phases.begin(), phases.end());
+    std::sort(ordered.begin(), ordered.end(), [](auto const& a, auto const& b) {
+        return a.second.firstStart < b.second.firstStart;
+    });
+    
+    std::ostringstream out;
+    for (auto const& [name, totals] : ordered) {
+        out << name << ": " << totals.micros / 1000.0 << " ms";
+        if (totals.count > 1) out << " over " << totals.count << " runs";
+        if (totals.objects > 0) out << ", " << totals.objects << " objects";
+        if (totals.bytes > 0) out << ", " << totals.bytes << " bytes";
+        out << "\n";
+    }
+    return out.str();
+}
+
+bool writeChromeTrace(std::filesystem::path const& path, std::vector<ImportTrace::Event> const& events) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) return false;
+    
+    out << "{\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); i++) {
+        auto const& event = events[i];
+        if (i > 0) out << ",";
+        out << "\n{\"name\":\"" << event.name << "\",\"cat\":\"import\",\"ph\":\"X\""
+            << ",\"ts\":" << event.startMicros << ",\"dur\":" << event.durationMicros
+            << ",\"pid\":1,\"tid\":" << event.thread << ",\"args\":{";
+        bool first = true;
+        if (event.objects >= 0) {
+            out << "\"objects\":" << event.objects;
+            first = false;
+        }
+        if (event.bytes >= 0) {
+            out << (first ? "" : ",") << "\"bytes\":" << event.bytes;
+        }
+        out << "}}";
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
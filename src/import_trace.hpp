@@ -0,0 +1,71 @@
+#ifndef IG_IMPORTTRACE
+#define IG_IMPORTTRACE
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Collects timed phases of one import so slow imports can be diagnosed from a
+// log. Each traced import has its own, passed down to whatever it runs the
+// same way as its ImportProgress, so imports running side by side never mix
+// their events. Without a trace (a null pointer) a TraceScope records nothing.
+class ImportTrace {
+    public:
+    struct Event {
+        // Phase names are always string literals, so they outlive the trace
+        std::string_view name;
+        uint64_t startMicros;
+        uint64_t durationMicros;
+        uint32_t thread;
+        int64_t objects;
+        int64_t bytes;
+    };
+    
+    private:
+    // Never changes after construction, so reading it needs no lock
+    const std::chrono::steady_clock::time_point m_origin = std::chrono::steady_clock::now();
+    std::mutex m_mutex;
+    std::vector<Event> m_events;
+    
+    public:
+    // Microseconds since the trace was created
+    uint64_t now() const;
+    void record(Event const& event);
+    // Hands back everything recorded so far
+    std::vector<Event> takeEvents();
+};
+
+class TraceScope {
+    private:
+    ImportTrace* m_trace;
+    std::string_view m_name;
+    uint64_t m_start = 0;
+    int64_t m_objects = -1;
+    int64_t m_bytes = -1;
+    
+    public:
+    TraceScope(ImportTrace* trace, std::string_view name);
+    ~TraceScope();
+    
+    TraceScope(TraceScope const&) = delete;
+    TraceScope& operator=(TraceScope const&) = delete;
+    
+    // Records the phase now rather than at the end of the scope
+    void end();
+    
+    void setObjects(int64_t objects) { m_objects = objects; }
+    void setBytes(int64_t bytes) { m_bytes = bytes; }
+};
+
+// One line per phase: how often it ran, total time, objects and bytes
+std::string formatTraceSummary(std::vector<ImportTrace::Event> const& events);
+
+// Writes the events in Chrome's trace event format, for chrome://tracing or
+// Perfetto
+bool writeChromeTrace(std::filesystem::path const& path, std::vector<ImportTrace::Event> const& events);
+
+#endif
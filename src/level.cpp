@@ -0,0 +1,98 @@
+#include "level.hpp"
+#include "byte_cursor.hpp"
+#include "level_format.hpp"
+#include "mapped_file.hpp"
+
+#include <algorithm>
+
+namespace {
+    // Clamps reservations so a corrupt count can't make us allocate more
+    // than the file could possibly hold
+    size_t reserveCount(int count, ByteCursor const& cursor, size_t recordSize) {
+        if (count <= 0) return 0;
+        return std::min(static_cast<size_t>(count), cursor.maxRecords(recordSize));
+    }
+}
+
+Level::Level(std::filesystem::path const& path, std::pmr::memory_resource* resource)
+    : m_blocks(resource), m_backgrounds(resource), m_gravity(resource), m_rising(resource), m_falling(resource) {
+    MappedFile file(path);
+    if (!file.isOpen()) return;
+    parse(file.bytes());
+}
+
+Level::Level(std::span<const std::byte> data, std::pmr::memory_resource* resource)
+    : m_blocks(resource), m_backgrounds(resource), m_gravity(resource), m_rising(resource), m_falling(resource) {
+    parse(data);
+}
+
+void Level::parse(std::span<const std::byte> data) {
+    if (data.size() < 10) return;
+    
+    // The version picks the layout once; nothing after this checks it
+    ByteCursor cursor(data);
+    m_formatVersion = cursor.readI32();
+    withLevelFormat(m_formatVersion, [&](auto format) { parseAs<decltype(format)>(cursor); });
+}
+
+template <class Format>
+void Level::parseAs(ByteCursor& cursor) {
+    if constexpr (Format::HAS_CUSTOM_GRAPHICS_FLAG) {
+        m_customGraphics = cursor.readU8() != 0;
+    }
+    
+    // A truncated table still yields the blocks that were there in full
+    constexpr auto BLOCKS = Format::BLOCKS;
+    int numBlocks = readBlockCount<Format>(cursor);
+    size_t readableBlocks = reserveCount(numBlocks, cursor, BLOCKS.recordSize);
+    decodeBlockRecordsAs<BLOCKS>(cursor.readBytes(readableBlocks * BLOCKS.recordSize), m_blocks);
+    if (readableBlocks < static_cast<size_t>(numBlocks)) return;
+    
+    m_endPos = cursor.readI32();
+    
+    int numBG = cursor.readI32();
+    m_backgrounds.reserve(reserveCount(numBG, cursor, Format::BACKGROUND_RECORD_MIN));
+    for (int i = 0; i < numBG; i++) {
+        int x = cursor.readI32();
+        uint8_t isCustom = cursor.readU8();
+        
+        if (isCustom == 0) {
+            int colorID = cursor.readI32();
+            if (!cursor) return;
+            m_backgrounds.push_back({x, colorID, nullptr, false, ""});
+        } else {
+            auto texturePath = cursor.readString(cursor.readU16());
+            if (!cursor) return;
+            m_backgrounds.push_back({x, 0, nullptr, true, std::pmr::string(texturePath, resource())});
+        }
+    }
+    
+    int numGrav = cursor.readI32();
+    m_gravity.reserve(reserveCount(numGrav, cursor, Format::GRAVITY_RECORD_SIZE));
+    for (int i = 0; i < numGrav; i++) {
+        int x = cursor.readI32();
+        if (!cursor) return;
+        m_gravity.push_back({x});
+    }
+    
+    int numRise = cursor.readI32();
+    m_rising.reserve(reserveCount(numRise, cursor, Format::RANGE_RECORD_SIZE));
+    for (int i = 0; i < numRise; i++) {
+        int start = cursor.readI32();
+        int end = cursor.readI32();
+        if (!cursor) return;
+        m_rising.push_back({start, end});
+    }
+    
+    int numFall = cursor.readI32();
+    m_falling.reserve(reserveCount(numFall, cursor, Format::RANGE_RECORD_SIZE));
+    for (int i = 0; i < numFall; i++) {
+        int start = cursor.readI32();
+        int end = cursor.readI32();
+        if (!cursor) return;
+        m_falling.push_back({start, end});
+    }
+    
+    if (!cursor) return;
+    m_loaded = true;
+}
@@ -0,0 +1,59 @@
+#ifndef IG_LEVEL
+#define IG_LEVEL
+
+#include <cstddef>
+#include <filesystem>
+#include <memory_resource>
+#include <span>
+#include <vector>
+#include "gdstructs.hpp"
+
+class ByteCursor;
+
+class Level {
+    private:
+    BlockTable m_blocks;
+    std::pmr::vector<BackgroundChange> m_backgrounds;
+    std::pmr::vector<GravityChange> m_gravity;
+    std::pmr::vector<BlocksRise> m_rising;
+    std::pmr::vector<BlocksFall> m_falling;
+    int m_endPos = 3015;
+    int m_formatVersion = 0;
+    bool m_customGraphics = false;
+    bool m_loaded = false;
+    
+    void parse(std::span<const std::byte> data);
+    // Everything after the version, for one LevelFormat
+    template <class Format>
+    void parseAs(ByteCursor& cursor);
+    
+    public:
+    // Everything the level holds is allocated from resource, which has to
+    // outlive it. The emitter also takes its scratch space from there.
+    Level(std::filesystem::path const& path, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    Level(std::span<const std::byte> data, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    
+    std::pmr::memory_resource* resource() const { return m_backgrounds.get_allocator().resource(); }
+    
+    int getBlockCount() const { return m_blocks.size(); }
+    BlockTable const& getBlocks() const { return m_blocks; }
+    int getBackgroundCount() const { return m_backgrounds.size(); }
+    BackgroundChange const* getBackgroundAtIndex(int i) const { return &m_backgrounds[i]; }
+    int getGravityCount() const { return m_gravity.size(); }
+    GravityChange const* getGravAtIndex(int i) const { return &m_gravity[i]; }
+    int getRisingCount() const { return m_rising.size(); }
+    BlocksRise const* getRisingAtIndex(int i) const { return &m_rising[i]; }
+    int getFallingCount() const { return m_falling.size(); }
+    BlocksFall const* getFallingAtIndex(int i) const { return &m_falling[i]; }
+    std::span<BackgroundChange const> getBackgrounds() const { return m_backgrounds; }
+    std::span<GravityChange const> getGravity() const { return m_gravity; }
+    std::span<BlocksRise const> getRising() const { return m_rising; }
+    std::span<BlocksFall const> getFalling() const { return m_falling; }
+    void setBackgroundTint(size_t i, int tint) { m_backgrounds[i].tint = tint; }
+    int getEndPos() const { return m_endPos; }
+    int getFormatVersion() const { return m_formatVersion; }
+    bool usesCustomGraphics() const { return m_customGraphics; }
+    bool getLoadedSuccessfully() const { return m_loaded; }
+};
+
+#endif
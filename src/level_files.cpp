@@ -0,0 +1,93 @@
+#include "level_files.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+namespace {
+    std::string toLower(std::string text) {
+        for (auto& c : text) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return text;
+    }
+    
+    std::string lowerExtension(std::filesystem::path const& path) {
+        return toLower(pathToUtf8(path.extension()));
+    }
+}
+
+std::string pathToUtf8(std::filesystem::path const& path) {
+    auto text = path.u8string();
+    return std::string(text.begin(), text.end());
+}
+
+std::filesystem::path pathFromUtf8(std::string_view text) {
+    return std::filesystem::path(std::u8string(text.begin(), text.end()));
+}
+
+bool hasLvlExtension(std::filesystem::path const& path) {
+    return lowerExtension(path) == ".lvl";
+}
+
+std::optional<std::filesystem::path> findLevelFileInBundle(std::filesystem::path const& bundle) {
+    std::error_code ec;
+    for (auto const& entry : std::filesystem::directory_iterator(bundle, ec)) {
+        if (!entry.is_regular_file(ec)) continue;
+        
+        auto ext = lowerExtension(entry.path());
+        if (ext == ".lvl" || ext == ".dat" || ext.empty()) {
+            return entry.path();
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<std::filesystem::path> findLevelFilesInTree(std::filesystem::path const& root) {
+    std::vector<std::filesystem::path> levels;
+    std::error_code ec;
+    
+    if (std::filesystem::is_directory(root, ec) && hasLvlExtension(root)) {
+        if (auto file = findLevelFileInBundle(root)) levels.push_back(*file);
+        return levels;
+    }
+    
+    auto options = std::filesystem::directory_options::skip_permission_denied;
+    std::filesystem::recursive_directory_iterator it(root, options, ec), end;
+    for (; !ec && it != end; it.increment(ec)) {
+        auto const& entry = *it;
+        if (!hasLvlExtension(entry.path())) continue;
+        
+        if (entry.is_directory(ec)) {
+            it.disable_recursion_pending();
+            if (auto file = findLevelFileInBundle(entry.path())) levels.push_back(*file);
+        }
+        else if (entry.is_regular_file(ec)) {
+            levels.push_back(entry.path());
+        }
+    }
+    
+    std::sort(levels.begin(), levels.end());
+    return levels;
+}
+
+std::string levelNameFromPath(std::filesystem::path const& path) {
+    std::string name;
+    
+    for (auto it = path.begin(); it != path.end(); ++it) {
+        auto part = pathToUtf8(*it);
+        if (part.size() >= 4 && toLower(part).substr(part.size() - 4) == ".lvl") {
+            name = pathToUtf8(std::filesystem::path(*it).stem());
+            break;
+        }
+    }
+    
+    if (name.empty() && hasLvlExtension(path)) {
+        name = pathToUtf8(path.stem());
+    }
+    
+    if (!name.empty()) {
+        name[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(name[0])));
+    } else {
+        name = "Impossible Game Import";
+    }
+    
+    return name;
+}
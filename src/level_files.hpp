@@ -0,0 +1,30 @@
+#ifndef IG_LEVELFILES
+#define IG_LEVELFILES
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Finding and naming TIG levels on disk. Shared by the mod and the host-side
+// tools, so nothing in here depends on Geode.
+
+// UTF-8 form of a path on every platform, and back
+std::string pathToUtf8(std::filesystem::path const& path);
+std::filesystem::path pathFromUtf8(std::string_view text);
+
+bool hasLvlExtension(std::filesystem::path const& path);
+
+// TIG saves each level as a folder named after the level ending in .lvl, with
+// the level data inside it
+std::optional<std::filesystem::path> findLevelFileInBundle(std::filesystem::path const& bundle);
+
+// Every level under root, either a .lvl bundle folder or a bare .lvl file,
+// sorted so batches import in a stable order
+std::vector<std::filesystem::path> findLevelFilesInTree(std::filesystem::path const& root);
+
+// The level's name, taken from its bundle folder or file name
+std::string levelNameFromPath(std::filesystem::path const& path);
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef IG_LEVELFORMAT
+#define IG_LEVELFORMAT
+
+#include <cstddef>
+#include "block_decoder.hpp"
+#include "byte_cursor.hpp"
+
+// On-disk layouts of TIG level files. Every file starts with a big-endian i32
+// format version, and everything after it is described by a specialization of
+// LevelFormat. The layout is fixed at compile time, so the parser is
+// instantiated once per format and its per-record loops never check which
+// format they're reading.
+//
+// Supporting another format or platform variant means adding a
+// specialization and a case to withLevelFormat.
+template <int Version>
+struct LevelFormat;
+
+// The version TIG writes on desktop. The iOS version's .dat files have always
+// been read with this layout too.
+template <>
+struct LevelFormat<1> {
+    static constexpr int VERSION = 1;
+    
+    // Header after the version: u8 custom graphics flag, u16 block count
+    static constexpr bool HAS_CUSTOM_GRAPHICS_FLAG = true;
+    static constexpr size_t BLOCK_COUNT_SIZE = 2;
+    static constexpr BlockLayout BLOCKS = TIG_BLOCK_LAYOUT;
+    
+    // The sections after the block table each start with an i32 count
+    static constexpr size_t BACKGROUND_RECORD_MIN = 7;   // i32 x, u8 isCustom, u16 strLen
+    static constexpr size_t GRAVITY_RECORD_SIZE = 4;     // i32 x
+    static constexpr size_t RANGE_RECORD_SIZE = 8;       // i32 start, i32 end
+};
+
+constexpr int NEWEST_LEVEL_FORMAT = 1;
+
+// Calls reader with a LevelFormat for the given version. Unknown versions get
+// the newest known format, which is how every file was read before formats
+// were told apart, so files that used to import still do.
+template <class F>
+decltype(auto) withLevelFormat(int version, F&& reader) {
+    switch (version) {
+        case 1: return reader(LevelFormat<1> {});
+    }
+    return reader(LevelFormat<NEWEST_LEVEL_FORMAT> {});
+}
+
+inline bool isKnownLevelFormat(int version) {
+    return withLevelFormat(version, [version](auto format) { return decltype(format)::VERSION == version; });
+}
+
+template <class Format>
+int readBlockCount(ByteCursor& cursor) {
+    static_assert(Format::BLOCK_COUNT_SIZE == 2 || Format::BLOCK_COUNT_SIZE == 4);
+    if constexpr (Format::BLOCK_COUNT_SIZE == 2) return cursor.readU16();
+    else return cursor.readI32();
+}
+
+#endif
@@ -0,0 +1,205 @@
+#include "level_preview_popup.hpp"
+
+using namespace geode::prelude;
+
+namespace {
+    constexpr float POPUP_WIDTH = 380.f;
+    constexpr float POPUP_HEIGHT = 270.f;
+    constexpr float LIST_WIDTH = 340.f;
+    constexpr float LIST_HEIGHT = 150.f;
+    constexpr float ROW_HEIGHT = 34.f;
+    
+    std::string describeLevel(LevelPreview const& level) {
+        if (!level.summary) return "Couldn't read this file";
+        auto const& summary = *level.summary;
+        if (!summary.complete || !summary.looksLikeLevel()) return "Not a valid Impossible Game level";
+        
+        auto text = fmt::format(
+            "{} blocks, {} backgrounds, {} gravity, {} rise, {} fall",
+            summary.blockCount, summary.backgroundCount, summary.gravityCount, summary.risingCount, summary.fallingCount
+        );
+        if (summary.customBackgroundCount > 0) text += fmt::format(" ({} custom)", summary.customBackgroundCount);
+        return text;
+    }
+}
+
+LevelPreviewPopup* LevelPreviewPopup::create(std::vector<LevelPreview> levels, ImportCallback onImport, std::function<void()> onCancel) {
+    auto ret = new LevelPreviewPopup();
+    if (ret->init(std::move(levels), std::move(onImport), std::move(onCancel))) {
+        ret->autorelease();
+        return ret;
+    }
+    delete ret;
+    return nullptr;
+}
+
+bool LevelPreviewPopup::init(std::vector<LevelPreview> levels, ImportCallback onImport, std::function<void()> onCancel) {
+    if (!this->initWithColor({ 0, 0, 0, 105 })) return false;
+    m_levels = std::move(levels);
+    m_onImport = std::move(onImport);
+    m_onCancel = std::move(onCancel);
+    m_noElasticity = true;
+    
+    auto winSize = CCDirector::get()->getWinSize();
+    CCPoint center { winSize.width / 2, winSize.height / 2 };
+    
+    m_mainLayer = CCLayer::create();
+    this->addChild(m_mainLayer);
+    
+    auto bg = CCScale9Sprite::create("GJ_square01.png", { 0, 0, 80, 80 });
+    bg->setContentSize({ POPUP_WIDTH, POPUP_HEIGHT });
+    bg->setPosition(center);
+    m_mainLayer->addChild(bg);
+    
+    auto title = CCLabelBMFont::create(fmt::format("Found {} Levels", m_levels.size()).c_str(), "goldFont.fnt");
+    title->setScale(.8f);
+    title->setPosition(center + ccp(0, POPUP_HEIGHT / 2 - 22));
+    m_mainLayer->addChild(title);
+    
+    CCPoint listOrigin = center + ccp(-LIST_WIDTH / 2, -LIST_HEIGHT / 2 + 8);
+    auto listBg = CCLayerColor::create({ 0, 0, 0, 75 }, LIST_WIDTH, LIST_HEIGHT);
+    listBg->setPosition(listOrigin);
+    m_mainLayer->addChild(listBg);
+    
+    // Rows are laid out top down inside a content layer at least as tall as
+    // the view, so a short list still starts at the top
+    auto list = ScrollLayer::create({ LIST_WIDTH, LIST_HEIGHT });
+    list->setPosition(listOrigin);
+    float contentHeight = std::max(LIST_HEIGHT, ROW_HEIGHT * m_levels.size());
+    list->m_contentLayer->setContentSize({ LIST_WIDTH, contentHeight });
+    m_toggles.resize(m_levels.size(), nullptr);
+    for (size_t i = 0; i < m_levels.size(); i++) {
+        auto row = this->createRow(i, { LIST_WIDTH, ROW_HEIGHT });
+        row->setPosition({ 0, contentHeight - ROW_HEIGHT * (i + 1) });
+        list->m_contentLayer->addChild(row);
+    }
+    list->scrollToTop();
+    m_mainLayer->addChild(list);
+    
+    auto selectMenu = CCMenu::create();
+    selectMenu->setPosition(listOrigin + ccp(12, -16));
+    auto selectAll = CCMenuItemExt::createTogglerWithStandardSprites(.5f, [this](CCMenuItemToggler* toggler) {
+        this->onSelectAll(toggler);
+    });
+    selectAll->toggle(true);
+    selectMenu->addChild(selectAll);
+    m_mainLayer->addChild(selectMenu);
+    
+    auto selectAllLabel = CCLabelBMFont::create("All", "bigFont.fnt");
+    selectAllLabel->setScale(.4f);
+    selectAllLabel->setAnchorPoint({ 0, .5f });
+    selectAllLabel->setPosition(listOrigin + ccp(26, -16));
+    m_mainLayer->addChild(selectAllLabel);
+    
+    m_selectedLabel = CCLabelBMFont::create("", "bigFont.fnt");
+    m_selectedLabel->setScale(.35f);
+    m_selectedLabel->setAnchorPoint({ 1, .5f });
+    m_selectedLabel->setPosition(listOrigin + ccp(LIST_WIDTH, -16));
+    m_mainLayer->addChild(m_selectedLabel);
+    this->updateSelectedLabel(nullptr);
+    
+    m_buttonMenu = CCMenu::create();
+    m_buttonMenu->setPosition(center + ccp(0, -POPUP_HEIGHT / 2 + 25));
+    m_buttonMenu->addChild(CCMenuItemSpriteExtra::create(
+        ButtonSprite::create("Cancel"), this, menu_selector(LevelPreviewPopup::onCancel)
+    ));
+    m_buttonMenu->addChild(CCMenuItemSpriteExtra::create(
+        ButtonSprite::create("Import"), this, menu_selector(LevelPreviewPopup::onImport)
+    ));
+    m_buttonMenu->alignItemsHorizontallyWithPadding(10.f);
+    m_mainLayer->addChild(m_buttonMenu);
+    
+    this->setTouchEnabled(true);
+    this->setKeypadEnabled(true);
+    handleTouchPriority(this);
+    return true;
+}
+
+CCNode* LevelPreviewPopup::createRow(size_t index, CCSize size) {
+    auto const& level = m_levels[index];
+    bool importable = level.importable();
+    
+    auto row = CCLayerColor::create({ 0, 0, 0, static_cast<GLubyte>(index % 2 ? 0 : 40) }, size.width, size.height);
+    
+    if (importable) {
+        auto menu = CCMenu::create();
+        menu->setPosition({ 16, size.height / 2 });
+        auto toggle = CCMenuItemExt::createTogglerWithStandardSprites(.55f, [this](CCMenuItemToggler* toggler) {
+            this->updateSelectedLabel(toggler);
+        });
+        toggle->toggle(true);
+        menu->addChild(toggle);
+        row->addChild(menu);
+        m_toggles[index] = toggle;
+    }
+    
+    auto name = CCLabelBMFont::create(level.name.c_str(), "bigFont.fnt");
+    name->setAnchorPoint({ 0, .5f });
+    name->setPosition({ 32, size.height / 2 + 6 });
+    name->limitLabelWidth(size.width - 40, .45f, .1f);
+    row->addChild(name);
+    
+    auto stats = CCLabelBMFont::create(describeLevel(level).c_str(), "chatFont.fnt");
+    stats->setAnchorPoint({ 0, .5f });
+    stats->setPosition({ 32, size.height / 2 - 8 });
+    stats->limitLabelWidth(size.width - 40, .5f, .1f);
+    row->addChild(stats);
+    
+    if (!importable) {
+        name->setOpacity(120);
+        stats->setColor({ 255, 120, 120 });
+    }
+    else {
+        stats->setColor({ 200, 200, 200 });
+    }
+    return row;
+}
+
+// A toggler's callback runs before it flips, so the one being clicked counts
+// as its future state
+void LevelPreviewPopup::updateSelectedLabel(CCMenuItemToggler* flipping) {
+    size_t selected = 0;
+    size_t importable = 0;
+    for (auto toggle : m_toggles) {
+        if (!toggle) continue;
+        importable++;
+        if (toggle == flipping ? !toggle->isToggled() : toggle->isToggled()) selected++;
+    }
+    m_selectedLabel->setString(fmt::format("{} of {} selected", selected, importable).c_str());
+}
+
+void LevelPreviewPopup::onSelectAll(CCMenuItemToggler* toggler) {
+    bool select = !toggler->isToggled();
+    for (auto toggle : m_toggles) {
+        if (toggle) toggle->toggle(select);
+    }
+    this->updateSelectedLabel(nullptr);
+}
+
+void LevelPreviewPopup::keyBackClicked() {
+    this->onCancel(nullptr);
+}
+
+void LevelPreviewPopup::onImport(CCObject*) {
+    std::vector<std::filesystem::path> selected;
+    for (size_t i = 0; i < m_levels.size(); i++) {
+        if (m_toggles[i] && m_toggles[i]->isToggled()) selected.push_back(m_levels[i].path);
+    }
+    if (selected.empty()) return;
+    
+    auto callback = std::move(m_onImport);
+    this->close();
+    callback(std::move(selected));
+}
+
+void LevelPreviewPopup::onCancel(CCObject*) {
+    auto callback = std::move(m_onCancel);
+    this->close();
+    if (callback) callback();
+}
+
+void LevelPreviewPopup::close() {
+    this->setKeypadEnabled(false);
+    this->setTouchEnabled(false);
+    this->removeFromParentAndCleanup(true);
+}
@@ -0,0 +1,49 @@
+#ifndef IG_LEVELPREVIEWPOPUP
+#define IG_LEVELPREVIEWPOPUP
+
+#include <Geode/Geode.hpp>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+#include "level_summary.hpp"
+
+struct LevelPreview {
+    std::filesystem::path path;
+    std::string name;
+    // Empty if the file couldn't be read
+    std::optional<LevelSummary> summary;
+    
+    bool importable() const { return summary && summary->complete && summary->looksLikeLevel(); }
+};
+
+// Lists the levels found by a batch import with a few stats each, so the user
+// can pick which ones to convert. Levels that fail the header scan are listed
+// but can't be selected.
+class LevelPreviewPopup : public FLAlertLayer {
+    public:
+    using ImportCallback = std::function<void(std::vector<std::filesystem::path>)>;
+    
+    protected:
+    std::vector<LevelPreview> m_levels;
+    ImportCallback m_onImport;
+    std::function<void()> m_onCancel;
+    // One per level, null for levels that can't be imported
+    std::vector<CCMenuItemToggler*> m_toggles;
+    cocos2d::CCLabelBMFont* m_selectedLabel = nullptr;
+    
+    bool init(std::vector<LevelPreview> levels, ImportCallback onImport, std::function<void()> onCancel);
+    cocos2d::CCNode* createRow(size_t index, cocos2d::CCSize size);
+    void updateSelectedLabel(CCMenuItemToggler* flipping);
+    void keyBackClicked() override;
+    void onImport(cocos2d::CCObject*);
+    void onCancel(cocos2d::CCObject*);
+    void onSelectAll(CCMenuItemToggler* toggler);
+    void close();
+    
+    public:
+    static LevelPreviewPopup* create(std::vector<LevelPreview> levels, ImportCallback onImport, std::function<void()> onCancel);
+};
+
+#endif
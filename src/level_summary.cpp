@@ -0,0 +1,87 @@
+#include "level_summary.hpp"
+#include "byte_cursor.hpp"
+#include "level_format.hpp"
+#include "mapped_file.hpp"
+
+#include <algorithm>
+
+namespace {
+    // Skips a section of fixed-size records. A negative count reads as an
+    // empty section, as it does in Level.
+    int skipRecords(ByteCursor& cursor, size_t recordSize) {
+        int count = cursor.readI32();
+        if (count <= 0) return 0;
+        cursor.skip(static_cast<size_t>(count) * recordSize);
+        return cursor ? count : 0;
+    }
+    
+    // Mirrors Level::parseAs, minus the decoding. Custom texture paths are
+    // only copied out if texturePaths is given.
+    template <class Format>
+    void readSummaryAs(ByteCursor& cursor, LevelSummary& summary, std::vector<std::string>* texturePaths) {
+        if constexpr (Format::HAS_CUSTOM_GRAPHICS_FLAG) {
+            summary.customGraphics = cursor.readU8() != 0;
+        }
+        
+        constexpr auto BLOCKS = Format::BLOCKS;
+        int numBlocks = readBlockCount<Format>(cursor);
+        summary.blockCount = static_cast<int>(std::min<size_t>(numBlocks, cursor.maxRecords(BLOCKS.recordSize)));
+        if (summary.blockCount < numBlocks) return;
+        cursor.skip(static_cast<size_t>(numBlocks) * BLOCKS.recordSize);
+        
+        summary.endPos = cursor.readI32();
+        if (!cursor) return;
+        
+        int numBG = cursor.readI32();
+        for (int i = 0; i < numBG; i++) {
+            cursor.skip(4);
+            if (cursor.readU8() == 0) {
+                cursor.skip(4);
+            } else {
+                auto path = cursor.readString(cursor.readU16());
+                if (texturePaths && cursor) texturePaths->emplace_back(path);
+                summary.customBackgroundCount++;
+            }
+            if (!cursor) return;
+            summary.backgroundCount++;
+        }
+        
+        summary.gravityCount = skipRecords(cursor, Format::GRAVITY_RECORD_SIZE);
+        summary.risingCount = skipRecords(cursor, Format::RANGE_RECORD_SIZE);
+        summary.fallingCount = skipRecords(cursor, Format::RANGE_RECORD_SIZE);
+        
+        summary.complete = cursor.ok();
+    }
+}
+
+namespace {
+    std::optional<LevelSummary> scanLevel(std::span<const std::byte> data, std::vector<std::string>* texturePaths) {
+        if (data.size() < 10) return std::nullopt;
+        
+        ByteCursor cursor(data);
+        LevelSummary summary;
+        summary.formatVersion = cursor.readI32();
+        withLevelFormat(summary.formatVersion, [&](auto format) {
+            readSummaryAs<decltype(format)>(cursor, summary, texturePaths);
+        });
+        return summary;
+    }
+}
+
+std::optional<LevelSummary> readLevelSummary(std::span<const std::byte> data) {
+    return scanLevel(data, nullptr);
+}
+
+std::optional<LevelSummary> readLevelSummary(std::filesystem::path const& path) {
+    // Mapping the file means the skipped block table is never even read
+    // from disk, apart from the pages it shares with the header and footer
+    MappedFile file(path);
+    if (!file.isOpen()) return std::nullopt;
+    return readLevelSummary(file.bytes());
+}
+
+std::vector<std::string> readCustomTexturePaths(std::span<const std::byte> data) {
+    std::vector<std::string> paths;
+    scanLevel(data, &paths);
+    return paths;
+}
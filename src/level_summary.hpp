@@ -0,0 +1,43 @@
+#ifndef IG_LEVELSUMMARY
+#define IG_LEVELSUMMARY
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+// What a level holds, without loading it. Only the header and the section
+// counts are read: the block table is skipped over in one step, since its
+// records are fixed-size, so a summary costs the same for a level of ten
+// blocks or a million. Background records vary in length and are walked, but
+// their texture paths are only copied by readCustomTexturePaths.
+struct LevelSummary {
+    int formatVersion = 0;
+    bool customGraphics = false;
+    int blockCount = 0;
+    int endPos = 3015;
+    int backgroundCount = 0;
+    int customBackgroundCount = 0;
+    int gravityCount = 0;
+    int risingCount = 0;
+    int fallingCount = 0;
+    // False when the file ends before the last section, which Level would
+    // reject as well
+    bool complete = false;
+    
+    // Same test the import uses to reject files that aren't TIG levels at all
+    bool looksLikeLevel() const { return !(blockCount == 0 && backgroundCount == 0 && endPos == 3015); }
+};
+
+// Empty if the data is too short to even hold a header
+std::optional<LevelSummary> readLevelSummary(std::span<const std::byte> data);
+std::optional<LevelSummary> readLevelSummary(std::filesystem::path const& path);
+
+// The stored path of every custom background, in order, read the same way
+// as a summary; for checking the textures a level uses without parsing it
+std::vector<std::string> readCustomTexturePaths(std::span<const std::byte> data);
+
+#endif
@@ -0,0 +1,175 @@
+#include "level_watcher.hpp"
+#include "background_textures.hpp"
+#include "compressor.hpp"
+#include "hash.hpp"
+#include "worker_pool.hpp"
+
+using namespace geode::prelude;
+
+namespace {
+    constexpr float POLL_INTERVAL = 1.f;
+    
+    struct FileStamp {
+        std::filesystem::file_time_type lastWrite;
+        uintmax_t size = 0;
+        bool ok = false;
+    };
+    
+    FileStamp stampFile(std::filesystem::path const& path) {
+        FileStamp stamp;
+        std::error_code ec;
+        stamp.lastWrite = std::filesystem::last_write_time(path, ec);
+        if (ec) return stamp;
+        stamp.size = std::filesystem::file_size(path, ec);
+        stamp.ok = !ec;
+        return stamp;
+    }
+    
+    uint64_t hashLevelString(gd::string const& levelString) {
+        return hashBytes(std::as_bytes(std::span(levelString.c_str(), levelString.size())));
+    }
+    
+    void warnEditedInGame(std::filesystem::path const& path, GJGameLevel* level) {
+        log::warn("Stopped watching {}, its level was edited in GD", utils::string::pathToString(path));
+        Notification::create(
+            fmt::format("{} was edited in GD, so it won't be reloaded", std::string(level->m_levelName)),
+            NotificationIcon::Warning
+        )->show();
+    }
+}
+
+LevelWatcher* LevelWatcher::get() {
+    // Never released; lives as long as the game
+    static auto watcher = new LevelWatcher();
+    return watcher;
+}
+
+void LevelWatcher::watch(std::filesystem::path const& path, GJGameLevel* level, EmitOptions const& options) {
+    stop();
+    
+    m_path = path;
+    m_level = level;
+    m_options = options;
+    m_writtenHash = hashLevelString(level->m_levelString);
+    m_busy = true;
+    uint32_t generation = ++m_generation;
+    
+    // Only the file's stamp is needed up front; the level is converted from
+    // scratch whenever it changes
+    async::runtime().spawnBlocking<void>([this, path, generation]() {
+        auto stamp = stampFile(path);
+        queueInMainThread([this, stamp, generation]() {
+            if (generation != m_generation) return;
+            m_busy = false;
+            if (!stamp.ok) {
+                log::warn("Couldn't read {} to watch it for changes", utils::string::pathToString(m_path));
+                stop();
+                return;
+            }
+            m_lastWrite = stamp.lastWrite;
+            m_lastSize = stamp.size;
+            CCScheduler::get()->scheduleSelector(schedule_selector(LevelWatcher::poll), this, POLL_INTERVAL, false);
+            log::info("Watching {} for changes", utils::string::pathToString(m_path));
+        });
+    });
+}
+
+void LevelWatcher::stop() {
+    CCScheduler::get()->unscheduleSelector(schedule_selector(LevelWatcher::poll), this);
+    m_generation++;
+    m_level = nullptr;
+    m_busy = false;
+}
+
+// GD keeps the level string in the level itself and rewrites it when the
+// level is saved in the editor, so any change there means the user edited it
+bool LevelWatcher::editedInGame() const {
+    return hashLevelString(m_level->m_levelString) != m_writtenHash;
+}
+
+void LevelWatcher::poll(float) {
+    if (m_busy || !m_level) return;
+    
+    // The user deleted the level; nothing left to patch
+    if (!LocalLevelManager::get()->m_localLevels->containsObject(m_level)) {
+        log::info("Stopped watching {}, its level was deleted", utils::string::pathToString(m_path));
+        stop();
+        return;
+    }
+    if (this->editedInGame()) {
+        warnEditedInGame(m_path, m_level);
+        stop();
+        return;
+    }
+    
+    m_busy = true;
+    uint32_t generation = m_generation;
+    auto path = m_path;
+    auto options = m_options;
+    auto lastWrite = m_lastWrite;
+    auto lastSize = m_lastSize;
+    
+    async::runtime().spawnBlocking<void>([this, path, options, lastWrite, lastSize, generation]() {
+        auto stamp = stampFile(path);
+        if (!stamp.ok || (stamp.lastWrite == lastWrite && stamp.size == lastSize)) {
+            queueInMainThread([this, generation]() { finishPoll(generation); });
+            return;
+        }
+        
+        // TIG may be saving the file right now, so it's copied into memory
+        // and closed straight away rather than mapped: truncating a mapped
+        // file crashes the reader on some platforms, and holding it open
+        // could make TIG's save fail. If the copy doesn't parse, the stamp is
+        // left alone so the next poll tries again.
+        auto data = file::readBinary(path);
+        if (data.isErr()) {
+            queueInMainThread([this, generation]() { finishPoll(generation); });
+            return;
+        }
+        auto bytes = std::move(data).unwrap();
+        Level igLevel(std::as_bytes(std::span(bytes)));
+        if (!igLevel.getLoadedSuccessfully()) {
+            queueInMainThread([this, generation]() { finishPoll(generation); });
+            return;
+        }
+        
+        loadBackgroundTints(igLevel, path.parent_path(), &spawnOnWorkerPool);
+        
+        // Formatting and compressing are both linear in the level and run in
+        // parallel, so converting again costs about as much as diffing would
+        auto compressed = buildCompressedObjectString(igLevel, options, &spawnOnWorkerPool);
+        if (!compressed) {
+            queueInMainThread([this, generation]() { finishPoll(generation); });
+            return;
+        }
+        
+        auto levelString = std::make_shared<std::string>(std::move(*compressed));
+        queueInMainThread([this, levelString, stamp, generation]() {
+            if (generation != m_generation) return;
+            
+            // Saved in GD while this reload was running
+            if (this->editedInGame()) {
+                warnEditedInGame(m_path, m_level);
+                stop();
+                return;
+            }
+            
+            m_level->m_levelString = *levelString;
+            m_writtenHash = hashLevelString(m_level->m_levelString);
+            m_lastWrite = stamp.lastWrite;
+            m_lastSize = stamp.size;
+            
+            log::info("Reloaded {}", utils::string::pathToString(m_path));
+            Notification::create(
+                fmt::format("Reloaded {}", std::string(m_level->m_levelName)),
+                NotificationIcon::Success
+            )->show();
+            finishPoll(generation);
+        });
+    });
+}
+
+void LevelWatcher::finishPoll(uint32_t generation) {
+    if (generation != m_generation) return;
+    m_busy = false;
+}
@@ -0,0 +1,39 @@
+#ifndef IG_LEVELWATCHER
+#define IG_LEVELWATCHER
+
+#include <Geode/Geode.hpp>
+#include <cstdint>
+#include <filesystem>
+#include "emitter.hpp"
+
+// Watches the source .lvl of the last imported level. When the file changes,
+// it's reparsed and converted again in the background, and the imported
+// level's string is replaced in place instead of importing a new copy.
+//
+// A level that was edited in GD since the watcher last wrote it is left
+// alone: the watcher warns and stops rather than overwrite those edits.
+class LevelWatcher : public cocos2d::CCObject {
+    private:
+    std::filesystem::path m_path;
+    geode::Ref<GJGameLevel> m_level;
+    EmitOptions m_options;
+    // Hash of the level string the watcher expects GD to still have
+    uint64_t m_writtenHash = 0;
+    std::filesystem::file_time_type m_lastWrite;
+    uintmax_t m_lastSize = 0;
+    bool m_busy = false;
+    // Bumped on every watch() so results for a previous level are dropped
+    uint32_t m_generation = 0;
+    
+    bool editedInGame() const;
+    void poll(float);
+    void finishPoll(uint32_t generation);
+    
+    public:
+    static LevelWatcher* get();
+    
+    void watch(std::filesystem::path const& path, GJGameLevel* level, EmitOptions const& options);
+    void stop();
+};
+
+#endif
@@ -1,211 +1,25 @@
 #include <Geode/Geode.hpp>
 #include <Geode/modify/LevelBrowserLayer.hpp>
-#include "gdstructs.hpp"
-#include "compat_defs.hpp"
+#include <deque>
+#include <thread>
+#include "level.hpp"
+#include "background_textures.hpp"
+#include "compressor.hpp"
+#include "conversion_cache.hpp"
+#include "import_arena.hpp"
+#include "import_progress.hpp"
+#include "import_progress_popup.hpp"
+#include "import_trace.hpp"
+#include "level_files.hpp"
+#include "level_format.hpp"
+#include "level_preview_popup.hpp"
+#include "level_summary.hpp"
+#include "level_watcher.hpp"
+#include "mapped_file.hpp"
+#include "worker_pool.hpp"
 
 using namespace geode::prelude;
 
-class Level {
-    private:
-    std::vector<BlockObject> m_blocks;
-    std::vector<BackgroundChange> m_backgrounds;
-    std::vector<GravityChange> m_gravity;
-    std::vector<BlocksRise> m_rising;
-    std::vector<BlocksFall> m_falling;
-    int m_endPos = 3015;
-    bool m_loaded = false;
-    
-    int readInt(ByteVector const& data, size_t& offset) {
-        if (offset + 4 > data.size()) return -1;
-        
-        uint32_t b1 = static_cast<uint32_t>(data[offset]);
-        uint32_t b2 = static_cast<uint32_t>(data[offset + 1]);
-        uint32_t b3 = static_cast<uint32_t>(data[offset + 2]);
-        uint32_t b4 = static_cast<uint32_t>(data[offset + 3]);
-        
-        offset += 4;
-        return static_cast<int>((b1 << 24) | (b2 << 16) | (b3 << 8) | b4);
-    }
-    
-    public:
-    Level(std::filesystem::path path) {
-        auto result = file::readBinary(path);
-        if (result.isErr()) return;
-        
-        auto data = result.unwrap();
-        if (data.size() < 10) return;
-        
-        size_t offset = 0;
-        
-        int formatVer = readInt(data, offset);
-        
-        uint8_t customGraphicsUnused = data[offset++];
-        
-        int numBlocks = (static_cast<int>(data[offset]) << 8) | static_cast<int>(data[offset + 1]);
-        offset += 2;
-        
-        for (int i = 0; i < numBlocks; i++) {
-            BlockObject obj;
-            uint8_t type = data[offset++]; 
-            obj.objType = static_cast<int>(type);
-            obj.indexInVec = i;
-            
-            
-            obj.xPos = readInt(data, offset);
-            obj.yPos = readInt(data, offset); 
-            
-            m_blocks.push_back(obj);
-        }
-        
-        m_endPos = readInt(data, offset);
-        
-        int numBG = readInt(data, offset);
-        for (int i = 0; i < numBG; i++) {
-            int x = readInt(data, offset);
-            uint8_t isCustom = data[offset++];
-            
-            if (isCustom == 0) {
-                int colorID = readInt(data, offset);
-                m_backgrounds.push_back({x, colorID, nullptr, false, ""});
-            } else {
-                int strLen = (static_cast<int>(data[offset]) << 8) | static_cast<int>(data[offset + 1]);
-                offset += 2;
-                std::string texturePath;
-                if (offset + strLen <= data.size()) {
-                    texturePath = std::string(reinterpret_cast<const char*>(data.data() + offset), strLen);
-                }
-                offset += strLen;
-                m_backgrounds.push_back({x, 0, nullptr, true, texturePath});
-            }
-        }
-        
-        int numGrav = readInt(data, offset);
-        for (int i = 0; i < numGrav; i++) {
-            m_gravity.push_back({readInt(data, offset)});
-        }
-        
-        int numRise = readInt(data, offset);
-        for (int i = 0; i < numRise; i++) {
-            int start = readInt(data, offset);
-            int end = readInt(data, offset);
-            m_rising.push_back({start, end});
-        }
-        
-        int numFall = readInt(data, offset);
-        for (int i = 0; i < numFall; i++) {
-            int start = readInt(data, offset);
-            int end = readInt(data, offset);
-            m_falling.push_back({start, end});
-        }
-        
-        m_loaded = true;
-    }
-    
-    int getBlockCount() { return m_blocks.size(); }
-    BlockObject* getBlockAtIndex(int i) { return &m_blocks[i]; }
-    int getBackgroundCount() { return m_backgrounds.size(); }
-    BackgroundChange* getBackgroundAtIndex(int i) { return &m_backgrounds[i]; }
-    int getGravityCount() { return m_gravity.size(); }
-    GravityChange* getGravAtIndex(int i) { return &m_gravity[i]; }
-    int getRisingCount() { return m_rising.size(); }
-    BlocksRise* getRisingAtIndex(int i) { return &m_rising[i]; }
-    int getFallingCount() { return m_falling.size(); }
-    BlocksFall* getFallingAtIndex(int i) { return &m_falling[i]; }
-    int getEndPos() { return m_endPos; }
-    bool getLoadedSuccessfully() { return m_loaded; }
-};
-
-std::string buildObjectString(Level inLevel) {
-    gdObj tempGD;
-    BlockObject* tempIG;
-    bool isPit = false;
-    std::string result = level_string_base;
-    
-    for (int i = 0; i < inLevel.getBlockCount(); i++) {
-        tempIG = inLevel.getBlockAtIndex(i);
-        
-        switch(tempIG->objType) {
-            case 0: tempGD.p1_id = "1"; break;
-            case 1: tempGD.p1_id = "8"; break;
-            case 2: tempGD.p1_id = "9"; isPit = true; break;
-        }
-        
-        if(!isPit) {
-            tempGD.p2_x = utils::numToString(tempIG->xPos - 135);
-            tempGD.p3_y = utils::numToString(tempIG->yPos + 15);
-            tempGD.p21_colorID = "0";
-            tempGD.p24_zLayer = "0";
-            result += "1," + tempGD.p1_id + ",2," + tempGD.p2_x + ",3," + tempGD.p3_y + ",21,0,24,0;";
-        }
-        else {
-            int iterations = round((tempIG->yPos - tempIG->xPos)/30) + 1;
-            int currentX = (tempIG->xPos - 135);
-            for(int j = 0; j < iterations; j++)
-            {
-                result += "1,9,2," + utils::numToString(currentX) + ",3,0,21,0,24,0;";
-                currentX += 30;
-            }
-        }
-        isPit = false;
-    }
-    
-    BackgroundChange* tempBC;
-    gdColorTrigger tempCT;
-    
-    for (int i = 0; i < inLevel.getBackgroundCount(); i++) {
-        tempBC = inLevel.getBackgroundAtIndex(i);
-        switch(tempBC->colorID) {
-            case 0: tempCT.p7_red = "63"; tempCT.p8_green = "184"; tempCT.p9_blue = "199"; break;
-            case 1: tempCT.p7_red = "236"; tempCT.p8_green = "216"; tempCT.p9_blue = "50"; break;
-            case 3: tempCT.p7_red = "178"; tempCT.p8_green = "38"; tempCT.p9_blue = "227"; break;
-            case 4: tempCT.p7_red = "241"; tempCT.p8_green = "19"; tempCT.p9_blue = "242"; break;
-            case 2: tempCT.p7_red = "83"; tempCT.p8_green = "255"; tempCT.p9_blue = "83"; break;
-            case 5: tempCT.p7_red = "0"; tempCT.p8_green = "0"; tempCT.p9_blue = "0"; break;
-        }
-        std::string xPosStr = utils::numToString(tempBC->xPos + 165);
-        result += "1,899,2," + xPosStr + ",3,3000,7," + tempCT.p7_red + ",8," + tempCT.p8_green + ",9," + tempCT.p9_blue + ",10,0.25,23,1000,155,1,35,1;";
-        result += "1,899,2," + xPosStr + ",3,3030,7," + tempCT.p7_red + ",8," + tempCT.p8_green + ",9," + tempCT.p9_blue + ",10,0.25,23,1001,155,1,35,1;";
-        result += "1,899,2," + xPosStr + ",3,3060,7," + tempCT.p7_red + ",8," + tempCT.p8_green + ",9," + tempCT.p9_blue + ",10,0.25,23,1009,155,1,35,1;";
-    }
-    
-    GravityChange* tempGC;
-    gdMirrorPortal tempMP;
-    gdCameraObj tempCO;
-    bool currentlyInverted = false;
-    
-    for (int i = 0; i < inLevel.getGravityCount(); i++) {
-        tempGC = inLevel.getGravAtIndex(i);
-        tempMP.objID = currentlyInverted ? "46" : "45";
-        tempCO.rotation = currentlyInverted ? "0" : "180";
-        currentlyInverted = !currentlyInverted;
-        std::string xPosStr = utils::numToString(tempGC->xPos + 165);
-        result += tempMP.base + tempMP.objID + tempMP.middle + xPosStr + tempMP.remainder + ";";
-        result += tempCO.base + xPosStr + tempCO.middle + tempCO.rotation + ";";
-    }
-    
-    BlocksRise* tempBR;
-    gdBlocksRise tempGBR;
-    for (int i = 0; i < inLevel.getRisingCount(); i++) {
-        tempBR = inLevel.getRisingAtIndex(i);
-        tempGBR.xpos = utils::numToString(tempBR->startX - 465);
-        result += tempGBR.base + "23" + tempGBR.middle + tempGBR.xpos + tempGBR.remainder + ";";
-        tempGBR.xpos = (tempBR->startX == tempBR->endX) ? utils::numToString(inLevel.getEndPos() - 495) : utils::numToString(tempBR->endX - 495);
-        result += tempGBR.base + "1915" + tempGBR.middle + tempGBR.xpos + tempGBR.remainder + ";";
-    }
-    
-    BlocksFall* tempBF;
-    gdBlocksFall tempGBF;
-    for (int i = 0; i < inLevel.getFallingCount(); i++) {
-        tempBF = inLevel.getFallingAtIndex(i);
-        tempGBF.xpos = utils::numToString(tempBF->startX - 135);
-        result += tempGBF.base + "23" + tempGBF.middle + tempGBF.xpos + tempGBF.remainder + ";";
-        tempGBF.xpos = (tempBF->startX == tempBF->endX) ? utils::numToString(inLevel.getEndPos() - 15) : utils::numToString(tempBF->endX - 15);
-        result += tempGBF.base + "1915" + tempGBF.middle + tempGBF.xpos + tempGBF.remainder + ";";
-    }
-    
-    return result;
-}
-
 static auto IMPORT_PICK_OPTIONS = file::FilePickOptions {
     std::nullopt,
     #ifndef GEODE_IS_IOS
@@ -226,13 +40,172 @@ static auto IMPORT_PICK_OPTIONS = file::FilePickOptions {
     #endif
 };
 
+constexpr auto IMPORT_CANCELLED = "Import cancelled";
+
+// Endings the user chose, which don't need an error popup
+static bool isQuietImportError(std::string const& error) {
+    return error == "No selection was made" || error == IMPORT_CANCELLED;
+}
+
+// The single import's picker returns a folder everywhere but iOS: either a
+// TIG level bundle, or a folder with a bare .lvl file in it. Runs on the
+// blocking pool, since listing the folder can be slow.
+static Result<std::filesystem::path> resolvePickedLevel(std::filesystem::path const& picked, ImportTrace* trace) {
+    #ifndef GEODE_IS_IOS
+    TraceScope scanTrace(trace, "scan directory");
+    std::error_code ec;
+    if (!std::filesystem::is_directory(picked, ec)) return Ok(picked);
+    
+    if (hasLvlExtension(picked)) {
+        if (auto file = findLevelFileInBundle(picked)) return Ok(*file);
+        return Err("No level files found in selected .lvl folder");
+    }
+    
+    auto filesResult = file::readDirectory(picked);
+    if (filesResult.isErr()) {
+        return Err("Failed to read directory: " + filesResult.unwrapErr());
+    }
+    for (auto const& filePath : filesResult.unwrap()) {
+        if (std::filesystem::is_regular_file(filePath, ec) && hasLvlExtension(filePath)) return Ok(filePath);
+    }
+    return Err("The chosen folder was not a .lvl");
+    #else
+    return Ok(picked);
+    #endif
+}
+
+static ConversionCache& conversionCache() {
+    static ConversionCache cache(Mod::get()->getSaveDir() / "conversion-cache");
+    return cache;
+}
+
+struct ConvertedLevel {
+    std::filesystem::path path;
+    std::string levelString;
+};
+
+struct BatchImport {
+    std::vector<ConvertedLevel> levels;
+    std::vector<std::string> failures;
+    // Cancelled partway; levels holds only what finished before that
+    bool cancelled = false;
+};
+
+// Conversion is deterministic, so re-importing an unchanged level produces the
+// exact same string
+static GJGameLevel* findIdenticalLocalLevel(std::string const& levelString) {
+    for (auto level : CCArrayExt<GJGameLevel*>(LocalLevelManager::get()->m_localLevels)) {
+        std::string_view existing(level->m_levelString.c_str(), level->m_levelString.size());
+        if (existing == levelString) return level;
+    }
+    return nullptr;
+}
+
+static GJGameLevel* createImportedLevel(std::filesystem::path const& path, std::string const& levelString) {
+    auto gdLevel = GJGameLevel::create();
+    gdLevel->m_levelType = GJLevelType::Editor;
+    gdLevel->m_levelString = levelString;
+    gdLevel->m_levelName = levelNameFromPath(path);
+    return gdLevel;
+}
+
+// Settings are read on the main thread when an import starts and passed into
+// the import coroutine by value, so they live in its frame
+static EmitOptions emitOptionsFromSettings() {
+    EmitOptions options;
+    options.compactGeometry = Mod::get()->getSettingValue<bool>("compact-geometry");
+    options.coalesceTriggers = Mod::get()->getSettingValue<bool>("coalesce-triggers");
+    options.sortByX = Mod::get()->getSettingValue<bool>("sort-objects");
+    return options;
+}
+
+// Each import gets its own trace, passed along with it like its progress;
+// null when tracing is off
+static std::shared_ptr<ImportTrace> startImportTrace() {
+    if (!Mod::get()->getSettingValue<bool>("trace-imports")) return nullptr;
+    return std::make_shared<ImportTrace>();
+}
+
+static void finishImportTrace(ImportTrace* trace) {
+    if (!trace) return;
+    
+    auto events = trace->takeEvents();
+    log::info("Import timings:\n{}", formatTraceSummary(events));
+    
+    if (Mod::get()->getSettingValue<bool>("export-import-trace")) {
+        auto path = Mod::get()->getSaveDir() / "import-trace.json";
+        if (writeChromeTrace(path, events)) {
+            log::info("Wrote import trace to {}", utils::string::pathToString(path));
+        } else {
+            log::warn("Failed to write import trace to {}", utils::string::pathToString(path));
+        }
+    }
+}
+
+// Reports the import's trace when a completion callback returns, whichever
+// way it returns
+struct ImportTraceReport {
+    std::shared_ptr<ImportTrace> trace;
+    ~ImportTraceReport() { finishImportTrace(trace.get()); }
+};
+
+static void watchIfEnabled(std::filesystem::path const& path, GJGameLevel* level) {
+    if (!Mod::get()->getSettingValue<bool>("watch-imports")) return;
+    LevelWatcher::get()->watch(path, level, emitOptionsFromSettings());
+}
+
+static void showMyLevels() {
+    auto scene = CCScene::create();
+    auto layer = LevelBrowserLayer::create(GJSearchObject::create(SearchType::MyLevels));
+    scene->addChild(layer);
+    CCDirector::sharedDirector()->replaceScene(CCTransitionFade::create(.5f, scene));
+}
+
 class $modify(ImportLayer, LevelBrowserLayer) {
     struct Fields {
+        async::TaskHolder<Result<std::filesystem::path>> m_pickTask;
         async::TaskHolder<Result<std::pair<std::filesystem::path, std::string>>> m_importTask;
+        async::TaskHolder<Result<std::vector<LevelPreview>>> m_batchScanTask;
+        async::TaskHolder<Result<BatchImport>> m_batchImportTask;
     };
     
-    static Result<std::string> processLevelFile(std::filesystem::path const& path) {
-        Level igLevel(path);
+    // Checks for cancellation between stages; the emit and compress stage
+    // checks again as it goes
+    static Result<std::string> processLevelFile(
+        std::filesystem::path const& path, EmitOptions const& options, ImportProgress* progress, ImportTrace* trace
+    ) {
+        if (progress->cancelled()) return Err(IMPORT_CANCELLED);
+        progress->setStage(ImportProgress::Stage::Parsing);
+        
+        TraceScope readTrace(trace, "read file");
+        MappedFile file(path);
+        if (!file.isOpen()) return Err("Failed to read the level file");
+        readTrace.setBytes(file.bytes().size());
+        readTrace.end();
+        
+        // Looked up before the level is even parsed, so re-importing an
+        // unchanged level costs one pass over its bytes. Custom backgrounds
+        // change the output too, so the key covers which files they are and
+        // when they last changed; their contents are only read on a miss.
+        TraceScope cacheTrace(trace, "cache lookup");
+        auto textureStamps = hashBackgroundTextureStamps(readCustomTexturePaths(file.bytes()), path.parent_path());
+        auto cacheKey = ConversionCache::keyFor(file.bytes(), options, textureStamps);
+        if (auto cached = conversionCache().load(cacheKey)) {
+            return Ok(std::move(*cached));
+        }
+        cacheTrace.end();
+        
+        // Everything the conversion allocates along the way is released with
+        // the arena, which outlives the level built on it
+        ImportArena arena(file.bytes().size());
+        TraceScope parseTrace(trace, "parse");
+        Level igLevel(file.bytes(), &arena);
+        parseTrace.setBytes(file.bytes().size());
+        parseTrace.setObjects(
+            igLevel.getBlockCount() + igLevel.getBackgroundCount() + igLevel.getGravityCount() +
+            igLevel.getRisingCount() + igLevel.getFallingCount()
+        );
+        parseTrace.end();
         
         if (igLevel.getBlockCount() == 0 && igLevel.getBackgroundCount() == 0 && igLevel.getEndPos() == 3015) {
             return Err("This is most likely not a valid Impossible Game level file");
@@ -240,93 +213,104 @@ class $modify(ImportLayer, LevelBrowserLayer) {
         if (!igLevel.getLoadedSuccessfully()) {
             return Err("This is not a valid Impossible Game level!");
         }
+        if (!isKnownLevelFormat(igLevel.getFormatVersion())) {
+            log::warn(
+                "{} is format version {}, which isn't known; read it as version {}",
+                levelNameFromPath(path), igLevel.getFormatVersion(), NEWEST_LEVEL_FORMAT
+            );
+        }
         
-        std::string innerLevelString = buildObjectString(igLevel);
-        return Ok(ZipUtils::compressString(innerLevelString, false, 0));
+        if (progress->cancelled()) return Err(IMPORT_CANCELLED);
+        progress->setStage(ImportProgress::Stage::Backgrounds);
+        
+        TraceScope textureTrace(trace, "read backgrounds");
+        auto textures = readBackgroundTextures(igLevel, path.parent_path());
+        textureTrace.end();
+        
+        // GD can't show the images themselves, so each one only lends its
+        // average colour to the background change that uses it
+        if (!textures.textures.empty()) {
+            TraceScope tintTrace(trace, "average backgrounds");
+            applyBackgroundTints(igLevel, textures, averageTextureColors(textures, &spawnOnWorkerPool));
+        }
+        
+        auto compressed = buildCompressedObjectString(igLevel, options, &spawnOnWorkerPool, progress, trace);
+        if (progress->cancelled()) return Err(IMPORT_CANCELLED);
+        if (!compressed) return Err("Failed to compress the imported level");
+        
+        if (trace) {
+            auto stats = arena.stats();
+            log::info(
+                "{}: {} arena allocations ({} KiB), which took {} ({} KiB) from the heap; allocations outside the arena aren't counted",
+                levelNameFromPath(path), stats.allocations, stats.bytes / 1024, stats.heapAllocations, stats.heapBytes / 1024
+            );
+        }
+        
+        TraceScope storeTrace(trace, "cache store");
+        conversionCache().store(cacheKey, *compressed);
+        return Ok(std::move(*compressed));
     }
     
     void onImport() {
-        m_fields->m_importTask.spawn(
-            "Importing Impossible Game Level",
-            [this]() -> arc::Future<Result<std::pair<std::filesystem::path, std::string>>> {
+        auto trace = startImportTrace();
+        m_fields->m_pickTask.spawn(
+            "Picking Impossible Game Level",
+            [](std::shared_ptr<ImportTrace> trace) -> arc::Future<Result<std::filesystem::path>> {
                 #ifdef GEODE_IS_IOS
                 auto mode = file::PickMode::OpenFile;
                 #else
                 auto mode = file::PickMode::OpenFolder;
                 #endif
                 
+                TraceScope pickTrace(trace.get(), "pick file");
                 auto pickResult = co_await file::pick(mode, IMPORT_PICK_OPTIONS);
+                pickTrace.end();
                 if (pickResult.isErr()) co_return Err(pickResult.unwrapErr());
                 
                 auto pathOpt = pickResult.unwrap();
                 if (!pathOpt.has_value()) co_return Err("No selection was made");
-                
-                std::filesystem::path finalPath = pathOpt.value();
-                
-                #ifndef GEODE_IS_IOS
-                if (std::filesystem::is_directory(finalPath)) {
-                    auto dirName = utils::string::toLower(utils::string::pathToString(finalPath.filename()));
-                    
-                    if (dirName.size() >= 4 && dirName.substr(dirName.size() - 4) == ".lvl") {
-                        
-                        auto filesResult = file::readDirectory(finalPath);
-                        if (filesResult.isErr()) {
-                            co_return Err("Failed to read directory: " + filesResult.unwrapErr());
-                        }
-                        
-                        auto files = filesResult.unwrap();
-                        bool found = false;
-                        
-                        for (auto const& filePath : files) {
-                            if (!std::filesystem::is_regular_file(filePath)) continue;
-                            
-                            auto ext = utils::string::toLower(utils::string::pathToString(filePath.extension()));
-                            
-                            if (ext == ".lvl" || ext == ".dat" || ext.empty()) {
-                                finalPath = filePath;
-                                found = true;
-                                break;
-                            }
-                        }
-                        
-                        if (!found) co_return Err("No level files found in selected .lvl folder");
-                    } else {
-                        auto filesResult = file::readDirectory(finalPath);
-                        
-                        if (filesResult.isErr()) {
-                            co_return Err("Failed to read directory: " + filesResult.unwrapErr());
-                        }
-                        
-                        auto files = filesResult.unwrap();
-                        bool found = false;
-                        
-                        for (auto const& filePath : files) {
-                            if (!std::filesystem::is_regular_file(filePath)) continue;
-                            
-                            auto ext = utils::string::toLower(utils::string::pathToString(filePath.extension()));
-                            
-                            if (ext == ".lvl") {
-                                finalPath = filePath;
-                                found = true;
-                                break;
-                            }
-                        }
-                        
-                        if (!found) co_return Err("The chosen folder was not a .lvl");
+                co_return Ok(pathOpt.value());
+            }(trace),
+            
+            [this, trace](Result<std::filesystem::path> result) {
+                if (result.isErr()) {
+                    ImportTraceReport report { trace };
+                    if (!isQuietImportError(result.unwrapErr())) {
+                        FLAlertLayer::create("Import Error", result.unwrapErr(), "OK")->show();
                     }
+                    return;
                 }
-                #endif
-                
-                co_return co_await async::runtime().spawnBlocking<Result<std::pair<std::filesystem::path, std::string>>>([path = finalPath]() -> Result<std::pair<std::filesystem::path, std::string>> {
-                    auto result = processLevelFile(path);
+                importLevel(result.unwrap(), trace);
+            }
+        );
+    }
+    
+    // Converts the level the user picked. Everything here can touch the
+    // filesystem, which may be slow (or on a network share), so it all runs
+    // on the pool.
+    void importLevel(std::filesystem::path picked, std::shared_ptr<ImportTrace> trace) {
+        auto progress = std::make_shared<ImportProgress>();
+        ImportProgressPopup::create(progress)->show();
+        m_fields->m_importTask.spawn(
+            "Importing Impossible Game Level",
+            [](
+                std::filesystem::path picked, EmitOptions options, std::shared_ptr<ImportProgress> progress, std::shared_ptr<ImportTrace> trace
+            ) -> arc::Future<Result<std::pair<std::filesystem::path, std::string>>> {
+                co_return co_await async::runtime().spawnBlocking<Result<std::pair<std::filesystem::path, std::string>>>([picked, options, progress, trace]() -> Result<std::pair<std::filesystem::path, std::string>> {
+                    auto path = resolvePickedLevel(picked, trace.get());
+                    if (path.isErr()) return Err(path.unwrapErr());
+                    
+                    auto result = processLevelFile(path.unwrap(), options, progress.get(), trace.get());
                     if (result.isErr()) return Err(result.unwrapErr());
-                    return Ok(std::make_pair(path, result.unwrap()));
+                    return Ok(std::make_pair(path.unwrap(), result.unwrap()));
                 });
-            }(),
+            }(std::move(picked), emitOptionsFromSettings(), progress, trace),
             
-            [](Result<std::pair<std::filesystem::path, std::string>> result) {
+            [progress, trace](Result<std::pair<std::filesystem::path, std::string>> result) {
+                ImportTraceReport report { trace };
+                progress->finish();
                 if (result.isErr()) {
-                    if (result.unwrapErr() != "No selection was made") {
+                    if (!isQuietImportError(result.unwrapErr())) {
                         FLAlertLayer::create("Import Error", result.unwrapErr(), "OK")->show();
                     }
                     return;
@@ -334,45 +318,214 @@ class $modify(ImportLayer, LevelBrowserLayer) {
                 
                 auto [path, levelString] = result.unwrap();
                 
-                std::string name;
+                if (auto existing = findIdenticalLocalLevel(levelString)) {
+                    watchIfEnabled(path, existing);
+                    FLAlertLayer::create(
+                        "Already Imported",
+                        fmt::format("This level is already in your levels as <cy>{}</c>.", std::string(existing->m_levelName)),
+                        "OK"
+                    )->show();
+                    return;
+                }
+                
+                {
+                    TraceScope insertTrace(trace.get(), "insert level");
+                    insertTrace.setBytes(levelString.size());
+                    auto gdLevel = createImportedLevel(path, levelString);
+                    LocalLevelManager::get()->m_localLevels->insertObject(gdLevel, 0);
+                    watchIfEnabled(path, gdLevel);
+                }
                 
-                for (auto it = path.begin(); it != path.end(); ++it) {
-                    auto part = utils::string::pathToString(*it);
-                    if (part.size() >= 4 && utils::string::toLower(part).substr(part.size() - 4) == ".lvl") {
-                        name = utils::string::pathToString(std::filesystem::path(part).stem());
-                        break;
+                TraceScope sceneTrace(trace.get(), "scene swap");
+                showMyLevels();
+            }
+        );
+    }
+    
+    #ifndef GEODE_IS_IOS
+    // Picks a folder and lists what's in it. Only each level's header and
+    // section counts are read, so even a folder of hundreds of levels lists
+    // almost instantly; the user then picks which ones to convert.
+    void onBatchImport() {
+        auto trace = startImportTrace();
+        m_fields->m_batchScanTask.spawn(
+            "Scanning Impossible Game Levels",
+            [](std::shared_ptr<ImportTrace> trace) -> arc::Future<Result<std::vector<LevelPreview>>> {
+                TraceScope pickTrace(trace.get(), "pick folder");
+                auto pickResult = co_await file::pick(file::PickMode::OpenFolder, IMPORT_PICK_OPTIONS);
+                pickTrace.end();
+                if (pickResult.isErr()) co_return Err(pickResult.unwrapErr());
+                
+                auto pathOpt = pickResult.unwrap();
+                if (!pathOpt.has_value()) co_return Err("No selection was made");
+                
+                auto previews = co_await async::runtime().spawnBlocking<std::vector<LevelPreview>>([root = pathOpt.value(), trace]() {
+                    TraceScope scanTrace(trace.get(), "scan directory");
+                    auto files = findLevelFilesInTree(root);
+                    scanTrace.setObjects(files.size());
+                    scanTrace.end();
+                    
+                    TraceScope summaryTrace(trace.get(), "read summaries");
+                    std::vector<LevelPreview> previews;
+                    previews.reserve(files.size());
+                    for (auto& file : files) {
+                        auto summary = readLevelSummary(file);
+                        auto name = levelNameFromPath(file);
+                        previews.push_back({ std::move(file), std::move(name), summary });
                     }
+                    summaryTrace.setObjects(previews.size());
+                    return previews;
+                });
+                if (previews.empty()) co_return Err("No Impossible Game levels were found in the chosen folder");
+                co_return Ok(std::move(previews));
+            }(trace),
+            
+            [this, trace](Result<std::vector<LevelPreview>> result) {
+                if (result.isErr()) {
+                    ImportTraceReport report { trace };
+                    if (!isQuietImportError(result.unwrapErr())) {
+                        FLAlertLayer::create("Import Error", result.unwrapErr(), "OK")->show();
+                    }
+                    return;
                 }
                 
-                if (name.empty()) {
-                    auto ext = utils::string::toLower(utils::string::pathToString(path.extension()));
-                    if (ext == ".lvl") {
-                        name = utils::string::pathToString(path.stem());
+                LevelPreviewPopup::create(
+                    result.unwrap(),
+                    [this, trace](std::vector<std::filesystem::path> files) { importLevels(std::move(files), trace); },
+                    [trace] { finishImportTrace(trace.get()); }
+                )->show();
+            }
+        );
+    }
+    
+    // Converts the levels chosen from a batch import's preview list
+    void importLevels(std::vector<std::filesystem::path> files, std::shared_ptr<ImportTrace> trace) {
+        auto progress = std::make_shared<ImportProgress>();
+        progress->setLevelsTotal(static_cast<uint32_t>(files.size()));
+        ImportProgressPopup::create(progress)->show();
+        m_fields->m_batchImportTask.spawn(
+            "Importing Impossible Game Levels",
+            [](
+                std::vector<std::filesystem::path> files, EmitOptions options, std::shared_ptr<ImportProgress> progress, std::shared_ptr<ImportTrace> trace
+            ) -> arc::Future<Result<BatchImport>> {
+                // Every conversion in the batch records into the batch's trace
+                auto spawnConversion = [options, progress, trace](std::filesystem::path path) {
+                    return async::runtime().spawnBlocking<Result<ConvertedLevel>>([path = std::move(path), options, progress, trace]() -> Result<ConvertedLevel> {
+                        auto result = processLevelFile(path, options, progress.get(), trace.get());
+                        if (result.isErr()) {
+                            return Err(fmt::format("{}: {}", levelNameFromPath(path), result.unwrapErr()));
+                        }
+                        return Ok(ConvertedLevel { path, result.unwrap() });
+                    });
+                };
+                
+                // Each conversion holds a parsed level and its compressed
+                // output, so only keep about one per core going at a time
+                size_t maxInFlight = std::max(2u, std::thread::hardware_concurrency());
+                std::deque<decltype(spawnConversion(std::filesystem::path()))> inFlight;
+                BatchImport batch;
+                batch.levels.reserve(files.size());
+                
+                // Once cancelled, nothing new is started and the conversions
+                // already running stop at their next checkpoint. Levels that
+                // finished before that are still imported.
+                for (size_t next = 0; next < files.size() || !inFlight.empty();) {
+                    if (next < files.size() && inFlight.size() < maxInFlight && !progress->cancelled()) {
+                        inFlight.push_back(spawnConversion(files[next++]));
+                        continue;
                     }
+                    if (inFlight.empty()) break;
+                    
+                    auto result = co_await std::move(inFlight.front());
+                    inFlight.pop_front();
+                    progress->levelDone();
+                    if (result.isOk()) {
+                        batch.levels.push_back(result.unwrap());
+                    } else if (!progress->cancelled()) {
+                        // After a cancel, errors are conversions that were
+                        // stopped, not ones that failed
+                        batch.failures.push_back(result.unwrapErr());
+                    }
+                }
+                
+                batch.cancelled = progress->cancelled();
+                co_return Ok(std::move(batch));
+            }(std::move(files), emitOptionsFromSettings(), progress, trace),
+            
+            [progress, trace](Result<BatchImport> result) {
+                ImportTraceReport report { trace };
+                progress->finish();
+                if (result.isErr()) {
+                    if (!isQuietImportError(result.unwrapErr())) {
+                        FLAlertLayer::create("Import Error", result.unwrapErr(), "OK")->show();
+                    }
+                    return;
+                }
+                
+                auto batch = result.unwrap();
+                for (auto const& failure : batch.failures) {
+                    log::warn("Skipped level during batch import: {}", failure);
+                }
+                
+                if (batch.levels.empty()) {
+                    if (!batch.cancelled) {
+                        FLAlertLayer::create("Import Error", "None of the selected levels could be imported", "OK")->show();
+                    }
+                    return;
                 }
                 
-                if (!name.empty()) {
-                    std::string first = name.substr(0, 1);
-                    utils::string::toUpperIP(first);
-                    name = first + name.substr(1);
-                } else {
-                    name = "Impossible Game Import";
+                // Inserted back to front so the batch reads in order at the
+                // top of My Levels. Checking as we go also catches identical
+                // files within the batch itself.
+                TraceScope insertTrace(trace.get(), "insert levels");
+                auto localLevels = LocalLevelManager::get()->m_localLevels;
+                size_t imported = 0;
+                size_t duplicates = 0;
+                for (auto it = batch.levels.rbegin(); it != batch.levels.rend(); ++it) {
+                    if (findIdenticalLocalLevel(it->levelString)) {
+                        duplicates++;
+                        continue;
+                    }
+                    localLevels->insertObject(createImportedLevel(it->path, it->levelString), 0);
+                    imported++;
                 }
+                insertTrace.setObjects(imported);
+                insertTrace.end();
                 
-                auto gdLevel = GJGameLevel::create();
-                gdLevel->m_levelType = GJLevelType::Editor;
-                gdLevel->m_levelString = levelString;
-                gdLevel->m_levelName = name;
+                // Nothing new, but not necessarily because it was all there
+                // already; some may have failed or been cancelled
+                if (imported == 0) {
+                    if (batch.cancelled) return;
+                    if (batch.failures.empty()) {
+                        FLAlertLayer::create("Already Imported", "Every selected level is already in your levels.", "OK")->show();
+                    } else {
+                        FLAlertLayer::create(
+                            "Nothing Imported",
+                            fmt::format(
+                                "<cy>{}</c> already in your levels, <cr>{}</c> failed to import (see the log for why).",
+                                duplicates, batch.failures.size()
+                            ),
+                            "OK"
+                        )->show();
+                    }
+                    return;
+                }
                 
-                LocalLevelManager::get()->m_localLevels->insertObject(gdLevel, 0);
+                TraceScope sceneTrace(trace.get(), "scene swap");
+                showMyLevels();
                 
-                auto scene = CCScene::create();
-                auto layer = LevelBrowserLayer::create(GJSearchObject::create(SearchType::MyLevels));
-                scene->addChild(layer);
-                CCDirector::sharedDirector()->replaceScene(CCTransitionFade::create(.5f, scene));
+                auto message = fmt::format("Imported {} levels", imported);
+                if (duplicates > 0) message += fmt::format(", {} already imported", duplicates);
+                if (!batch.failures.empty()) message += fmt::format(", {} failed", batch.failures.size());
+                if (batch.cancelled) message += ", the rest were cancelled";
+                Notification::create(
+                    message,
+                    batch.failures.empty() && !batch.cancelled ? NotificationIcon::Success : NotificationIcon::Warning
+                )->show();
             }
         );
     }
+    #endif
     
     bool init(GJSearchObject* search) {
         if (!LevelBrowserLayer::init(search)) return false;
@@ -381,7 +534,21 @@ class $modify(ImportLayer, LevelBrowserLayer) {
             auto btnMenu = this->getChildByID("new-level-menu");
             auto igImportBtn = CCMenuItemExt::createSpriteExtra(
                 CircleButtonSprite::createWithSpriteFrameName("file.png"_spr, .85f, CircleBaseColor::Pink, CircleBaseSize::Big),
-                [this](CCMenuItemSpriteExtra* btn) { onImport(); }
+                [this](CCMenuItemSpriteExtra* btn) {
+                    #ifdef GEODE_IS_IOS
+                    onImport();
+                    #else
+                    createQuickPopup(
+                        "Import",
+                        "Import a <cy>single level</c>, or <cy>every level</c> inside a folder?",
+                        "Single", "Folder",
+                        [this](FLAlertLayer*, bool folder) {
+                            if (folder) onBatchImport();
+                            else onImport();
+                        }
+                    );
+                    #endif
+                }
             );
             
             igImportBtn->setID("import-ig-level-button"_spr);
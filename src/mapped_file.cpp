@@ -0,0 +1,130 @@
+#include "mapped_file.hpp"
+
+#include <fstream>
+#include <utility>
+
+#if defined(__APPLE__)
+#include <TargetConditionals.h>
+#endif
+
+#if defined(__ANDROID__) || (defined(__APPLE__) && TARGET_OS_IPHONE)
+#define IG_MAPPEDFILE_BUFFERED
+#elif defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(std::filesystem::path const& path) {
+    #if defined(IG_MAPPEDFILE_BUFFERED)
+    std::ifstream stream(path, std::ios::binary | std::ios::ate);
+    if (!stream) return;
+    
+    auto size = static_cast<std::streamoff>(stream.tellg());
+    if (size < 0) return;
+    
+    m_buffer.resize(static_cast<size_t>(size));
+    stream.seekg(0);
+    if (!stream.read(reinterpret_cast<char*>(m_buffer.data()), size)) return;
+    
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+    m_open = true;
+    #elif defined(_WIN32)
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return;
+    m_file = file;
+    
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) { close(); return; }
+    
+    // Mapping a zero-length file fails, but it is still a valid (empty) read
+    if (size.QuadPart == 0) {
+        m_open = true;
+        return;
+    }
+    
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) { close(); return; }
+    m_mapping = mapping;
+    
+    auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) { close(); return; }
+    
+    m_data = static_cast<const std::byte*>(view);
+    m_size = static_cast<size_t>(size.QuadPart);
+    m_open = true;
+    #else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return;
+    }
+    
+    if (info.st_size == 0) {
+        ::close(fd);
+        m_open = true;
+        return;
+    }
+    
+    void* view = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file
+    ::close(fd);
+    if (view == MAP_FAILED) return;
+    
+    ::madvise(view, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+    
+    m_data = static_cast<const std::byte*>(view);
+    m_size = static_cast<size_t>(info.st_size);
+    m_open = true;
+    #endif
+}
+
+void MappedFile::close() {
+    #if defined(IG_MAPPEDFILE_BUFFERED)
+    m_buffer.clear();
+    m_buffer.shrink_to_fit();
+    #elif defined(_WIN32)
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping) CloseHandle(static_cast<HANDLE>(m_mapping));
+    if (m_file) CloseHandle(static_cast<HANDLE>(m_file));
+    m_mapping = nullptr;
+    m_file = nullptr;
+    #else
+    if (m_data) ::munmap(const_cast<std::byte*>(m_data), m_size);
+    #endif
+    m_data = nullptr;
+    m_size = 0;
+    m_open = false;
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this == &other) return *this;
+    close();
+    
+    m_buffer = std::move(other.m_buffer);
+    m_data = std::exchange(other.m_data, nullptr);
+    m_size = std::exchange(other.m_size, 0);
+    m_open = std::exchange(other.m_open, false);
+    #if defined(_WIN32)
+    m_file = std::exchange(other.m_file, nullptr);
+    m_mapping = std::exchange(other.m_mapping, nullptr);
+    #endif
+    return *this;
+}
@@ -0,0 +1,39 @@
+#ifndef IG_MAPPEDFILE
+#define IG_MAPPEDFILE
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+// Read-only view of a whole file. On desktop the file is memory-mapped so the
+// parser reads straight out of the page cache; on mobile (where mapping files
+// picked through the system picker is unreliable) it falls back to a single
+// buffered read.
+class MappedFile {
+    private:
+    const std::byte* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_open = false;
+    #if defined(_WIN32)
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+    #endif
+    std::vector<std::byte> m_buffer;
+    
+    void close();
+    
+    public:
+    explicit MappedFile(std::filesystem::path const& path);
+    ~MappedFile();
+    
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    
+    bool isOpen() const { return m_open; }
+    std::span<const std::byte> bytes() const { return { m_data, m_size }; }
+};
+
+#endif
@@ -0,0 +1,93 @@
+#include "optimizer.hpp"
+#include "compat_defs.hpp"
+
+#include <algorithm>
+#include <tuple>
+
+namespace {
+    constexpr int GRID_SIZE = 30;
+    
+    // GD loads objects by the section their centre falls in, so a very long
+    // object pops in late at its edges. Keep merged runs short enough that
+    // this isn't noticeable.
+    constexpr int MAX_MERGED_RUN = 16;
+    
+    bool canMerge(int id) {
+        return id == gd_defblock || id == gd_pit;
+    }
+    
+    bool sameColor(gdColorTrigger const& a, gdColorTrigger const& b) {
+        return a.p7_red == b.p7_red && a.p8_green == b.p8_green && a.p9_blue == b.p9_blue;
+    }
+}
+
+void compactBlocks(std::pmr::vector<gdObj>& objects) {
+    // Group by kind and row so runs are contiguous
+    std::sort(objects.begin(), objects.end(), [](gdObj const& a, gdObj const& b) {
+        return std::tie(a.p1_id, a.p3_y, a.p2_x) < std::tie(b.p1_id, b.p3_y, b.p2_x);
+    });
+    objects.erase(std::unique(objects.begin(), objects.end(), [](gdObj const& a, gdObj const& b) {
+        return a.p1_id == b.p1_id && a.p2_x == b.p2_x && a.p3_y == b.p3_y;
+    }), objects.end());
+    
+    size_t out = 0;
+    for (size_t i = 0; i < objects.size();) {
+        gdObj start = objects[i];
+        int runLength = 1;
+        
+        if (canMerge(start.p1_id)) {
+            while (
+                runLength < MAX_MERGED_RUN &&
+                i + runLength < objects.size() &&
+                objects[i + runLength].p1_id == start.p1_id &&
+                objects[i + runLength].p3_y == start.p3_y &&
+                objects[i + runLength].p2_x == start.p2_x + runLength * GRID_SIZE
+            ) {
+                runLength++;
+            }
+        }
+        
+        // Object positions are centres, so a merged run sits halfway along
+        start.p2_x += (runLength - 1) * GRID_SIZE / 2;
+        start.p128_scaleX = runLength;
+        objects[out++] = start;
+        i += runLength;
+    }
+    objects.resize(out);
+    
+    std::sort(objects.begin(), objects.end(), [](gdObj const& a, gdObj const& b) {
+        return std::tie(a.p2_x, a.p3_y) < std::tie(b.p2_x, b.p3_y);
+    });
+}
+
+void coalesceColorTriggers(std::pmr::vector<gdColorTrigger>& triggers, gdColorTrigger const& initialColor) {
+    std::stable_sort(triggers.begin(), triggers.end(), [](gdColorTrigger const& a, gdColorTrigger const& b) {
+        return a.p2_x < b.p2_x;
+    });
+    
+    gdColorTrigger const* current = &initialColor;
+    size_t out = 0;
+    for (size_t i = 0; i < triggers.size(); i++) {
+        // A later trigger at the same x overrides this one
+        if (i + 1 < triggers.size() && triggers[i + 1].p2_x == triggers[i].p2_x) continue;
+        if (sameColor(triggers[i], *current)) continue;
+        
+        triggers[out] = triggers[i];
+        current = &triggers[out];
+        out++;
+    }
+    triggers.resize(out);
+}
+
+void coalesceGravityFlips(std::pmr::vector<int>& flips) {
+    std::sort(flips.begin(), flips.end());
+    
+    size_t out = 0;
+    for (size_t i = 0; i < flips.size();) {
+        size_t count = 1;
+        while (i + count < flips.size() && flips[i + count] == flips[i]) count++;
+        if (count % 2 == 1) flips[out++] = flips[i];
+        i += count;
+    }
+    flips.resize(out);
+}
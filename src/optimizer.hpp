@@ -0,0 +1,26 @@
+#ifndef IG_OPTIMIZER
+#define IG_OPTIMIZER
+
+#include <memory_resource>
+#include <vector>
+#include "gdstructs.hpp"
+
+// Shrinks a list of converted block/spike/pit objects:
+//  - objects with the same ID at the same position are collapsed into one
+//  - horizontal runs of blocks or pits, 30 units apart at the same height,
+//    become a single object stretched with scale X
+// Spikes are never merged, since stretching one changes its hitbox shape.
+// The result is sorted by x, then y.
+void compactBlocks(std::pmr::vector<gdObj>& objects);
+
+// Drops background colour triggers that don't change anything. Triggers are
+// ordered by x; of several at the same x only the last one in file order is
+// kept, and any that set the colour already in effect (starting from
+// initialColor) are removed. Only p2_x and the colour fields are looked at.
+void coalesceColorTriggers(std::pmr::vector<gdColorTrigger>& triggers, gdColorTrigger const& initialColor);
+
+// Gravity flips at the same x cancel out in pairs. Sorts the flips by x and
+// keeps one flip for every position with an odd number of them.
+void coalesceGravityFlips(std::pmr::vector<int>& flips);
+
+#endif
@@ -0,0 +1,153 @@
+#include "png_codec.hpp"
+#include "byte_cursor.hpp"
+
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <zlib.h>
+
+namespace {
+    constexpr uint8_t PNG_SIGNATURE[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    
+    enum ColorType : uint8_t {
+        Grey = 0,
+        Rgb = 2,
+        Palette = 3,
+        GreyAlpha = 4,
+        Rgba = 6,
+    };
+    
+    int channelsFor(uint8_t colorType) {
+        switch (colorType) {
+            case Grey: return 1;
+            case Rgb: return 3;
+            case Palette: return 1;
+            case GreyAlpha: return 2;
+            case Rgba: return 4;
+        }
+        return 0;
+    }
+    
+    uint8_t paeth(int left, int up, int upLeft) {
+        int estimate = left + up - upLeft;
+        int toLeft = std::abs(estimate - left);
+        int toUp = std::abs(estimate - up);
+        int toUpLeft = std::abs(estimate - upLeft);
+        if (toLeft <= toUp && toLeft <= toUpLeft) return static_cast<uint8_t>(left);
+        if (toUp <= toUpLeft) return static_cast<uint8_t>(up);
+        return static_cast<uint8_t>(upLeft);
+    }
+    
+    // Undoes the per-row filters in place; each row starts with its filter byte
+    bool unfilter(std::vector<uint8_t>& data, size_t rowBytes, size_t rows, size_t pixelBytes) {
+        const uint8_t* previous = nullptr;
+        for (size_t y = 0; y < rows; y++) {
+            uint8_t* row = data.data() + y * (rowBytes + 1);
+            uint8_t filter = row[0];
+            row++;
+            
+            for (size_t x = 0; x < rowBytes; x++) {
+                int left = x >= pixelBytes ? row[x - pixelBytes] : 0;
+                int up = previous ? previous[x] : 0;
+                int upLeft = previous && x >= pixelBytes ? previous[x - pixelBytes] : 0;
+                switch (filter) {
+                    case 0: break;
+                    case 1: row[x] += left; break;
+                    case 2: row[x] += up; break;
+                    case 3: row[x] += (left + up) / 2; break;
+                    case 4: row[x] += paeth(left, up, upLeft); break;
+                    default: return false;
+                }
+            }
+            previous = row;
+        }
+        return true;
+    }
+}
+
+std::optional<Image> decodePng(std::span<const std::byte> data) {
+    if (data.size() < sizeof(PNG_SIGNATURE) || std::memcmp(data.data(), PNG_SIGNATURE, sizeof(PNG_SIGNATURE)) != 0) {
+        return std::nullopt;
+    }
+    
+    ByteCursor cursor(data);
+    cursor.skip(sizeof(PNG_SIGNATURE));
+    
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint8_t colorType = 0;
+    std::vector<std::array<uint8_t, 4>> palette;
+    std::string compressed;
+    
+    while (cursor.remaining() > 0) {
+        uint32_t length = static_cast<uint32_t>(cursor.readI32());
+        auto type = cursor.readString(4);
+        auto body = cursor.readBytes(length);
+        cursor.skip(4); // CRC; zlib's own checksum already catches corrupt data
+        if (!cursor) return std::nullopt;
+        
+        ByteCursor chunk(body);
+        if (type == "IHDR") {
+            width = static_cast<uint32_t>(chunk.readI32());
+            height = static_cast<uint32_t>(chunk.readI32());
+            uint8_t bitDepth = chunk.readU8();
+            colorType = chunk.readU8();
+            chunk.skip(2); // compression and filter method, both always 0
+            uint8_t interlace = chunk.readU8();
+            if (!chunk || bitDepth != 8 || interlace != 0 || channelsFor(colorType) == 0) return std::nullopt;
+            if (width == 0 || height == 0 || width > MAX_PNG_SIDE || height > MAX_PNG_SIDE) return std::nullopt;
+        }
+        else if (type == "PLTE") {
+            palette.resize(body.size() / 3);
+            for (auto& entry : palette) {
+                entry = { chunk.readU8(), chunk.readU8(), chunk.readU8(), 255 };
+            }
+        }
+        else if (type == "tRNS" && colorType == Palette) {
+            for (size_t i = 0; i < body.size() && i < palette.size(); i++) {
+                palette[i][3] = chunk.readU8();
+            }
+        }
+        else if (type == "IDAT") {
+            compressed.append(reinterpret_cast<const char*>(body.data()), body.size());
+        }
+        else if (type == "IEND") {
+            break;
+        }
+    }
+    if (width == 0) return std::nullopt;
+    
+    size_t pixelBytes = channelsFor(colorType);
+    size_t rowBytes = width * pixelBytes;
+    std::vector<uint8_t> raw((rowBytes + 1) * height);
+    uLongf rawSize = static_cast<uLongf>(raw.size());
+    if (uncompress(raw.data(), &rawSize, reinterpret_cast<const Bytef*>(compressed.data()), static_cast<uLong>(compressed.size())) != Z_OK) {
+        return std::nullopt;
+    }
+    if (rawSize != raw.size() || !unfilter(raw, rowBytes, height, pixelBytes)) return std::nullopt;
+    
+    Image image;
+    image.width = width;
+    image.height = height;
+    image.pixels.resize(static_cast<size_t>(width) * height * 4);
+    
+    uint8_t* out = image.pixels.data();
+    for (size_t y = 0; y < height; y++) {
+        const uint8_t* row = raw.data() + y * (rowBytes + 1) + 1;
+        for (size_t x = 0; x < width; x++, out += 4) {
+            const uint8_t* in = row + x * pixelBytes;
+            switch (colorType) {
+                case Grey: out[0] = out[1] = out[2] = in[0]; out[3] = 255; break;
+                case GreyAlpha: out[0] = out[1] = out[2] = in[0]; out[3] = in[1]; break;
+                case Rgb: std::memcpy(out, in, 3); out[3] = 255; break;
+                case Rgba: std::memcpy(out, in, 4); break;
+                case Palette:
+                    if (in[0] >= palette.size()) return std::nullopt;
+                    std::memcpy(out, palette[in[0]].data(), 4);
+                    break;
+            }
+        }
+    }
+    return image;
+}
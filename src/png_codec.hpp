@@ -0,0 +1,25 @@
+#ifndef IG_PNGCODEC
+#define IG_PNGCODEC
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+// 8-bit RGBA pixels, rows top to bottom with no padding
+struct Image {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> pixels;
+};
+
+// Just enough PNG for TIG's custom backgrounds, on top of the zlib the
+// compressor already uses: non-interlaced images with 8 bits per channel, in
+// any colour type. Anything else (or anything bigger than MAX_PNG_SIDE on a
+// side) decodes to nullopt.
+constexpr uint32_t MAX_PNG_SIDE = 4096;
+
+std::optional<Image> decodePng(std::span<const std::byte> data);
+
+#endif
@@ -0,0 +1,100 @@
+#include "work_stealing_pool.hpp"
+
+#include <algorithm>
+
+namespace {
+    // Which worker of which pool the current thread is, if any
+    thread_local const void* t_pool = nullptr;
+    thread_local size_t t_workerIndex = 0;
+}
+
+WorkStealingPool::WorkStealingPool(size_t threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    
+    m_workers.reserve(threads);
+    for (size_t i = 0; i < threads; i++) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    m_threads.reserve(threads);
+    for (size_t i = 0; i < threads; i++) {
+        m_threads.emplace_back([this, i] { run(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard lock(m_stateMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (auto& thread : m_threads) thread.join();
+}
+
+void WorkStealingPool::submit(Job job) {
+    size_t target = t_pool == this
+        ? t_workerIndex
+        : m_nextWorker.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+    
+    // Counted before it's pushed, so a worker can never take a job that
+    // isn't counted yet
+    {
+        std::lock_guard lock(m_stateMutex);
+        m_queued++;
+        m_unfinished++;
+    }
+    {
+        std::lock_guard lock(m_workers[target]->mutex);
+        m_workers[target]->jobs.push_back(std::move(job));
+    }
+    m_wake.notify_one();
+}
+
+bool WorkStealingPool::takeJob(size_t self, Job& job) {
+    for (size_t offset = 0; offset < m_workers.size(); offset++) {
+        auto& worker = *m_workers[(self + offset) % m_workers.size()];
+        std::lock_guard lock(worker.mutex);
+        if (worker.jobs.empty()) continue;
+        
+        if (offset == 0) {
+            job = std::move(worker.jobs.front());
+            worker.jobs.pop_front();
+        }
+        else {
+            job = std::move(worker.jobs.back());
+            worker.jobs.pop_back();
+        }
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::run(size_t self) {
+    t_pool = this;
+    t_workerIndex = self;
+    
+    while (true) {
+        Job job;
+        if (takeJob(self, job)) {
+            {
+                std::lock_guard lock(m_stateMutex);
+                m_queued--;
+            }
+            job();
+            
+            std::lock_guard lock(m_stateMutex);
+            if (--m_unfinished == 0) m_idle.notify_all();
+            continue;
+        }
+        
+        // A job is counted a moment before it lands in a deque, so waking
+        // with nothing to take yet is possible; it just loops
+        std::unique_lock lock(m_stateMutex);
+        m_wake.wait(lock, [&] { return m_stopping || m_queued > 0; });
+        if (m_stopping && m_queued == 0) return;
+    }
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock lock(m_stateMutex);
+    m_idle.wait(lock, [&] { return m_unfinished == 0; });
+}
@@ -0,0 +1,62 @@
+#ifndef IG_WORKSTEALINGPOOL
+#define IG_WORKSTEALINGPOOL
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads, each with its own job deque. A worker runs
+// jobs from the front of its own deque and, once that's empty, steals from
+// the back of the others', so a few huge levels among many small ones don't
+// leave threads idle while one worker is still backed up.
+class WorkStealingPool {
+    public:
+    using Job = std::function<void()>;
+    
+    private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+    
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+    std::atomic<size_t> m_nextWorker = 0;
+    
+    // Guards the counters below. Taken briefly on every submit and twice per
+    // job a worker runs, as well as when a thread sleeps or is woken; the
+    // deques themselves are only behind their own worker's mutex
+    std::mutex m_stateMutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    size_t m_queued = 0;
+    size_t m_unfinished = 0;
+    bool m_stopping = false;
+    
+    bool takeJob(size_t self, Job& job);
+    void run(size_t self);
+    
+    public:
+    // 0 threads means one per hardware thread
+    explicit WorkStealingPool(size_t threads = 0);
+    ~WorkStealingPool();
+    
+    WorkStealingPool(WorkStealingPool const&) = delete;
+    WorkStealingPool& operator=(WorkStealingPool const&) = delete;
+    
+    size_t threadCount() const { return m_threads.size(); }
+    
+    // Jobs submitted from a worker go on that worker's own deque, others are
+    // dealt out round-robin
+    void submit(Job job);
+    // Blocks until every submitted job has finished
+    void wait();
+};
+
+#endif
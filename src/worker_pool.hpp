@@ -0,0 +1,21 @@
+#ifndef IG_WORKERPOOL
+#define IG_WORKERPOOL
+
+#include <functional>
+#include "work_stealing_pool.hpp"
+
+// Fire-and-forget job on the mod's own worker threads. Used as the executor
+// for emit slices, compression chunks and texture decodes.
+//
+// Conversions run on the async runtime's blocking pool and wait for these
+// jobs, so they can't go on that pool too: once it filled up with waiting
+// conversions, nothing would be left to run what they're waiting for. The
+// jobs here never wait on each other, so this pool always drains.
+inline void spawnOnWorkerPool(std::function<void()> job) {
+    // Never released; joining threads while the game unloads the mod isn't
+    // safe on every platform
+    static auto pool = new WorkStealingPool();
+    pool->submit(std::move(job));
+}
+
+#endif